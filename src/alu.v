@@ -36,6 +36,59 @@ module alu (
   wire [SHAMT_WIDTH-1:0] shamt;
   assign shamt = srcb[SHAMT_WIDTH-1:0];
 
+  // Packed-SIMD lanes. Comparisons set every bit of a lane so the result can
+  // be used directly as a mask.
+  wire [XLEN-1:0] add8, sub8, cmpeq8, scmplt8, scmple8, ucmplt8, ucmple8;
+  wire [XLEN-1:0] smin8, smax8, umin8, umax8;
+  wire [XLEN-1:0] add16, sub16, cmpeq16, scmplt16, scmple16, ucmplt16, ucmple16;
+  wire [XLEN-1:0] smin16, smax16, umin16, umax16;
+  wire [7:0] absdiff8 [0:3];
+
+  genvar i;
+  generate
+    for (i = 0; i < 4; i = i + 1) begin : lane8
+      wire [7:0] a = srca[8*i +: 8];
+      wire [7:0] b = srcb[8*i +: 8];
+      wire slt = $signed(a) < $signed(b);
+      wire ult = a < b;
+
+      assign add8[8*i +: 8] = a + b;
+      assign sub8[8*i +: 8] = a - b;
+      assign cmpeq8[8*i +: 8] = {8{a == b}};
+      assign scmplt8[8*i +: 8] = {8{slt}};
+      assign scmple8[8*i +: 8] = {8{slt || a == b}};
+      assign ucmplt8[8*i +: 8] = {8{ult}};
+      assign ucmple8[8*i +: 8] = {8{ult || a == b}};
+      assign smin8[8*i +: 8] = slt ? a : b;
+      assign smax8[8*i +: 8] = slt ? b : a;
+      assign umin8[8*i +: 8] = ult ? a : b;
+      assign umax8[8*i +: 8] = ult ? b : a;
+      assign absdiff8[i] = ult ? b - a : a - b;
+    end
+
+    for (i = 0; i < 2; i = i + 1) begin : lane16
+      wire [15:0] a = srca[16*i +: 16];
+      wire [15:0] b = srcb[16*i +: 16];
+      wire slt = $signed(a) < $signed(b);
+      wire ult = a < b;
+
+      assign add16[16*i +: 16] = a + b;
+      assign sub16[16*i +: 16] = a - b;
+      assign cmpeq16[16*i +: 16] = {16{a == b}};
+      assign scmplt16[16*i +: 16] = {16{slt}};
+      assign scmple16[16*i +: 16] = {16{slt || a == b}};
+      assign ucmplt16[16*i +: 16] = {16{ult}};
+      assign ucmple16[16*i +: 16] = {16{ult || a == b}};
+      assign smin16[16*i +: 16] = slt ? a : b;
+      assign smax16[16*i +: 16] = slt ? b : a;
+      assign umin16[16*i +: 16] = ult ? a : b;
+      assign umax16[16*i +: 16] = ult ? b : a;
+    end
+  endgenerate
+
+  // Sum of absolute differences of the four unsigned bytes.
+  wire [XLEN-1:0] pbsad = absdiff8[0] + absdiff8[1] + absdiff8[2] + absdiff8[3];
+
   always @(*) begin
     case (op)
       ALU_ADD : out = srca + srcb;
@@ -52,6 +105,29 @@ module alu (
       ALU_SGE : out = {31'b0, $signed(srca) >= $signed(srcb)};
       ALU_SLTU : out = {31'b0, srca < srcb};
       ALU_SGEU : out = {31'b0, srca >= srcb};
+      ALU_ADD8 : out = add8;
+      ALU_ADD16 : out = add16;
+      ALU_SUB8 : out = sub8;
+      ALU_SUB16 : out = sub16;
+      ALU_CMPEQ8 : out = cmpeq8;
+      ALU_CMPEQ16 : out = cmpeq16;
+      ALU_SCMPLT8 : out = scmplt8;
+      ALU_SCMPLT16 : out = scmplt16;
+      ALU_SCMPLE8 : out = scmple8;
+      ALU_SCMPLE16 : out = scmple16;
+      ALU_UCMPLT8 : out = ucmplt8;
+      ALU_UCMPLT16 : out = ucmplt16;
+      ALU_UCMPLE8 : out = ucmple8;
+      ALU_UCMPLE16 : out = ucmple16;
+      ALU_SMIN8 : out = smin8;
+      ALU_SMIN16 : out = smin16;
+      ALU_SMAX8 : out = smax8;
+      ALU_SMAX16 : out = smax16;
+      ALU_UMIN8 : out = umin8;
+      ALU_UMIN16 : out = umin16;
+      ALU_UMAX8 : out = umax8;
+      ALU_UMAX16 : out = umax16;
+      ALU_PBSAD : out = pbsad;
       default : out = 0;
     endcase
   end
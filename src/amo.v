@@ -0,0 +1,49 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The AMO unit computes the value an atomic memory operation writes back to
+// memory. Plain stores and SC pass rs2 through unchanged.
+module amo (
+  input [AMO_OP_LEN-1:0] op,
+  input [XLEN-1:0] mem_data,
+  input [XLEN-1:0] rs2,
+
+  output reg [XLEN-1:0] out
+);
+
+  `include "constants.vh"
+
+  always @(*) begin
+    case (op)
+      AMO_ADD : out = mem_data + rs2;
+      AMO_XOR : out = mem_data ^ rs2;
+      AMO_AND : out = mem_data & rs2;
+      AMO_OR : out = mem_data | rs2;
+      AMO_MIN : out = ($signed(mem_data) < $signed(rs2)) ? mem_data : rs2;
+      AMO_MAX : out = ($signed(mem_data) > $signed(rs2)) ? mem_data : rs2;
+      AMO_MINU : out = (mem_data < rs2) ? mem_data : rs2;
+      AMO_MAXU : out = (mem_data > rs2) ? mem_data : rs2;
+      default : out = rs2;
+    endcase
+  end
+
+endmodule
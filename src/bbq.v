@@ -21,96 +21,262 @@
 
 
 module bbq #(
-  parameter PC_START    = `D_XLEN'h0,
-  parameter STACK_ADDR  = ~(`D_XLEN'h0),
-  parameter IMEM_NWORDS = (1 << XLEN) / XLEN,
-  parameter DMEM_NWORDS = (1 << XLEN) / XLEN
+  parameter ENABLE_COUNTERS = 1,
+  parameter FUSION          = 1,
+  parameter PC_START        = `D_XLEN'h0,
+  parameter STACK_ADDR      = ~(`D_XLEN'h0),
+  parameter PROF_PERIOD     = 0,
+  parameter IMEM_NWORDS     = (1 << XLEN) / XLEN,
+  parameter DMEM_NWORDS     = (1 << XLEN) / XLEN,
+  parameter SPARSE_MEM      = 0,
+  parameter UNIFIED_MEM     = 0,
+  parameter TCM_NWORDS      = 2048,
+  parameter DMEM_WAIT       = 0,
+  parameter DMA             = 0,
+  parameter DMA_BURST       = 4
 )(
   input clk,
   input reset,
+  input console_rx_valid,
+  input [7:0] console_rx_data,
+  input console_rx_eof,
 
-  output reg [XLEN-1:0] console_wdata,
-  output reg console_we,
-  output reg test_passed = 1'b0,
+  output [XLEN-1:0] console_wdata,
+  output console_we,
+  output console_rx_ready,
+  output test_passed,
+  output idle,
   output error
 );
 
   `include "constants.vh"
 
-  localparam CONSOLE_ADDR   = `D_XLEN'h1000_0000;
-  localparam TEST_STAT_ADDR = `D_XLEN'h2000_0000;
+  // The scratchpad answers TCM_NWORDS words from TCM_ADDR, which must be a
+  // power of two, and is left out when TCM_NWORDS is zero. Every other data
+  // access, including those to devices, stalls for DMEM_WAIT cycles to model
+  // a data memory slower than the core.
+  localparam TCM_ADDR = `D_XLEN'h0400_0000;
+  localparam TCM_SIZE = TCM_NWORDS * 4;
+  localparam WAIT_LEN = (DMEM_WAIT > 0) ? $clog2(DMEM_WAIT + 1) : 1;
+
+  // The DMA engine, left out when DMA is zero, takes over the data memory
+  // port while it runs. Data accesses of the core other than to the scratchpad
+  // and to the engine itself stall meanwhile and start waiting afterwards.
+  localparam DMA_ADDR = `D_XLEN'h0500_0000;
+  localparam DMA_SIZE = `D_XLEN'h0001_0000;
 
   wire [XLEN-1:0] imem_addr;
   wire [XLEN-1:0] imem_rdata;
+  wire [XLEN-1:0] imem_next_rdata;
   wire [XLEN-1:0] dmem_addr;
   wire [XLEN-1:0] dmem_rdata;
+  wire [XLEN-1:0] bus_rdata;
+  wire timer_irq;
+  wire [XLEN-1:0] prof_period;
   wire [XLEN-1:0] dmem_wmask;
   wire [XLEN-1:0] dmem_io_wdata;
   wire dmem_io_we;
-  reg [XLEN-1:0] dmem_wdata;
-  reg dmem_we;
+  wire [XLEN-1:0] dmem_wdata;
+  wire dmem_we;
+  wire dmem_re;
+  wire [XLEN-1:0] tcm_rdata;
+  wire tcm_we;
+  wire [XLEN-1:0] dma_rdata;
+  wire dma_busy;
+  wire [XLEN-1:0] dma_mem_addr;
+  wire [XLEN-1:0] dma_mem_wdata;
+  wire dma_mem_we;
+  reg [WAIT_LEN-1:0] wait_cnt;
+
+  wire is_tcm = (TCM_NWORDS > 0) &&
+                ((dmem_addr & ~(TCM_SIZE - 1)) == TCM_ADDR);
+  wire is_dma = DMA && ((dmem_addr & ~(DMA_SIZE - 1)) == DMA_ADDR);
+  wire dma_wait = (dmem_re || dmem_io_we) && dma_busy && ~is_tcm && ~is_dma;
+  wire stall = dma_wait ||
+               ((dmem_re || dmem_io_we) && ~is_tcm && (wait_cnt != DMEM_WAIT));
+
+  assign tcm_we = dmem_io_we && is_tcm;
+
+  // The data memory port, shared with the DMA engine.
+  wire [XLEN-1:0] mem_addr = dma_busy ? dma_mem_addr : dmem_addr;
+  wire [XLEN-1:0] mem_wdata = dma_busy ? dma_mem_wdata : dmem_wdata;
+  wire [XLEN-1:0] mem_wmask = dma_busy ? ~(`D_XLEN'b0) : dmem_wmask;
+  wire mem_we = dma_busy ? dma_mem_we : dmem_we;
+
+  always @(posedge clk) begin
+    if (reset || ~stall || dma_wait) wait_cnt <= 0;
+    else wait_cnt <= wait_cnt + 1;
+  end
 
   datapath #(
+    .ENABLE_COUNTERS(ENABLE_COUNTERS),
+    .FUSION(FUSION),
+    .PROF_PERIOD(PROF_PERIOD),
     .PC_START(PC_START),
     .STACK_ADDR(STACK_ADDR)
   ) datapath (
     // input
     .clk(clk),
     .reset(reset),
+    .stall(stall),
     .imem_rdata(imem_rdata),
-    .dmem_rdata(dmem_rdata),
+    .imem_next_rdata(imem_next_rdata),
+    .dmem_rdata(is_tcm ? tcm_rdata : is_dma ? dma_rdata : bus_rdata),
+    .bus_we(mem_we || tcm_we),
+    .bus_addr(tcm_we ? dmem_addr : mem_addr),
+    .timer_irq(timer_irq),
 
     // output
     .imem_addr(imem_addr),
     .dmem_addr(dmem_addr),
     .dmem_wdata(dmem_io_wdata),
     .dmem_wmask(dmem_wmask),
+    .dmem_re(dmem_re),
     .dmem_we(dmem_io_we),
+    .prof_period(prof_period),
+    .idle(idle),
     .error(error)
   );
 
-  wire is_console = dmem_io_we && (dmem_addr == CONSOLE_ADDR);
-  wire is_test_res = dmem_io_we && (dmem_addr == TEST_STAT_ADDR) && (dmem_io_wdata == 123456789);
-
-  always @(*) begin
-    dmem_we = 1'b0;
-    dmem_wdata = `D_XLEN'b0;
-    console_we = 1'b0;
-    console_wdata = `D_XLEN'b0;
-
-    if (is_console) begin
-      console_we = 1'b1;
-      console_wdata = dmem_io_wdata;
-    end else if (is_test_res) begin
-      test_passed = 1'b1;
-    end else begin
-      dmem_we = dmem_io_we;
-      dmem_wdata = dmem_io_wdata;
-    end
-  end
-
-  imem #(
-    .NWORDS(IMEM_NWORDS)
-  ) imem (
-    // input
-    .addr(imem_addr),
-
-    // output
-    .rdata(imem_rdata)
-  );
-
-  dmem #(
-    .NWORDS(DMEM_NWORDS)
-  ) dmem (
+  sysbus sysbus (
     // input
     .clk(clk),
+    .reset(reset),
     .addr(dmem_addr),
-    .wdata(dmem_wdata),
-    .wmask(dmem_wmask),
-    .we(dmem_we),
+    .wdata(dmem_io_wdata),
+    .we(dmem_io_we && ~is_tcm && ~is_dma && ~stall),
+    .re(dmem_re && ~is_tcm && ~is_dma && ~stall),
+    .dmem_rdata(dmem_rdata),
+    .prof_pc(imem_addr),
+    .prof_period(prof_period),
+    .prof_en(~error),
+    .console_rx_valid(console_rx_valid),
+    .console_rx_data(console_rx_data),
+    .console_rx_eof(console_rx_eof),
 
     // output
-    .rdata(dmem_rdata)
+    .rdata(bus_rdata),
+    .timer_irq(timer_irq),
+    .dmem_wdata(dmem_wdata),
+    .dmem_we(dmem_we),
+    .console_wdata(console_wdata),
+    .console_we(console_we),
+    .console_rx_ready(console_rx_ready),
+    .test_passed(test_passed)
   );
 
+  generate
+  if (TCM_NWORDS > 0) begin : scratchpad
+    tcm #(
+      .NWORDS(TCM_NWORDS)
+    ) tcm (
+      // input
+      .clk(clk),
+      .addr(dmem_addr),
+      .wdata(dmem_io_wdata),
+      .wmask(dmem_wmask),
+      .we(tcm_we),
+
+      // output
+      .rdata(tcm_rdata)
+    );
+  end else begin : scratchpad
+    assign tcm_rdata = `D_XLEN'b0;
+  end
+  endgenerate
+
+  generate
+  if (DMA) begin : dma_engine
+    dma #(
+      .BURST(DMA_BURST),
+      .WAIT(DMEM_WAIT)
+    ) dma (
+      // input
+      .clk(clk),
+      .reset(reset),
+      .addr(dmem_addr - DMA_ADDR),
+      .wdata(dmem_io_wdata),
+      .we(dmem_io_we && is_dma && ~stall),
+      .mem_rdata(dmem_rdata),
+
+      // output
+      .rdata(dma_rdata),
+      .busy(dma_busy),
+      .mem_addr(dma_mem_addr),
+      .mem_wdata(dma_mem_wdata),
+      .mem_we(dma_mem_we)
+    );
+  end else begin : dma_engine
+    assign dma_rdata = `D_XLEN'b0;
+    assign dma_busy = 1'b0;
+    assign dma_mem_addr = `D_XLEN'b0;
+    assign dma_mem_wdata = `D_XLEN'b0;
+    assign dma_mem_we = 1'b0;
+  end
+  endgenerate
+
+  // IMEM_NWORDS and DMEM_NWORDS are ignored with SPARSE_MEM. With UNIFIED_MEM
+  // both ports share one memory of the larger of the two sizes.
+  generate
+  if (SPARSE_MEM) begin : mem
+    sparse_mem sparse_mem (
+      // input
+      .clk(clk),
+      .reset(reset),
+      .imem_addr(imem_addr),
+      .dmem_addr(mem_addr),
+      .dmem_wdata(mem_wdata),
+      .dmem_wmask(mem_wmask),
+      .dmem_we(mem_we),
+
+      // output
+      .imem_rdata(imem_rdata),
+      .imem_next_rdata(imem_next_rdata),
+      .dmem_rdata(dmem_rdata)
+    );
+  end else if (UNIFIED_MEM) begin : mem
+    unified_mem #(
+      .NWORDS(IMEM_NWORDS > DMEM_NWORDS ? IMEM_NWORDS : DMEM_NWORDS)
+    ) unified_mem (
+      // input
+      .clk(clk),
+      .imem_addr(imem_addr),
+      .dmem_addr(mem_addr),
+      .dmem_wdata(mem_wdata),
+      .dmem_wmask(mem_wmask),
+      .dmem_we(mem_we),
+
+      // output
+      .imem_rdata(imem_rdata),
+      .imem_next_rdata(imem_next_rdata),
+      .dmem_rdata(dmem_rdata)
+    );
+  end else begin : mem
+    imem #(
+      .NWORDS(IMEM_NWORDS)
+    ) imem (
+      // input
+      .addr(imem_addr),
+
+      // output
+      .rdata(imem_rdata),
+      .next_rdata(imem_next_rdata)
+    );
+
+    dmem #(
+      .NWORDS(DMEM_NWORDS)
+    ) dmem (
+      // input
+      .clk(clk),
+      .addr(mem_addr),
+      .wdata(mem_wdata),
+      .wmask(mem_wmask),
+      .we(mem_we),
+
+      // output
+      .rdata(dmem_rdata)
+    );
+  end
+  endgenerate
+
 endmodule
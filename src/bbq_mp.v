@@ -0,0 +1,233 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// A multi-hart variant of bbq. NHARTS datapaths share the instruction memory
+// and an arbitrated data memory. Each hart starts at PC_START with its own
+// stack, STACK_SIZE bytes below the previous hart's. The profiler follows
+// hart 0. There is no console input; the receiver always reports its end.
+module bbq_mp #(
+  parameter NHARTS          = 2,
+  parameter ENABLE_COUNTERS = 1,
+  parameter FUSION          = 1,
+  parameter PROF_PERIOD     = 0,
+  parameter PC_START        = `D_XLEN'h0,
+  parameter STACK_ADDR      = ~(`D_XLEN'h0),
+  parameter STACK_SIZE      = `D_XLEN'h4000,
+  parameter IMEM_NWORDS     = (1 << XLEN) / XLEN,
+  parameter DMEM_NWORDS     = (1 << XLEN) / XLEN,
+  parameter SPARSE_MEM      = 0,
+  parameter UNIFIED_MEM     = 0
+)(
+  input clk,
+  input reset,
+
+  output [XLEN-1:0] console_wdata,
+  output console_we,
+  output test_passed,
+  output idle,
+  output error
+);
+
+  `include "constants.vh"
+
+  wire [NHARTS*XLEN-1:0] imem_addr;
+  wire [NHARTS*XLEN-1:0] imem_rdata;
+  wire [NHARTS*XLEN-1:0] imem_next_rdata;
+  wire [NHARTS*XLEN-1:0] hart_addr;
+  wire [NHARTS*XLEN-1:0] hart_wdata;
+  wire [NHARTS*XLEN-1:0] hart_wmask;
+  wire [NHARTS-1:0] hart_re;
+  wire [NHARTS-1:0] hart_we;
+  wire [NHARTS-1:0] hart_stall;
+  wire [NHARTS-1:0] hart_idle;
+  wire [NHARTS-1:0] hart_error;
+  wire [NHARTS*XLEN-1:0] hart_prof_period;
+
+  wire [XLEN-1:0] dmem_addr;
+  wire [XLEN-1:0] dmem_rdata;
+  wire [XLEN-1:0] bus_rdata;
+  wire [NHARTS-1:0] timer_irq;
+  wire [XLEN-1:0] dmem_wmask;
+  wire [XLEN-1:0] dmem_io_wdata;
+  wire dmem_io_we;
+  wire [XLEN-1:0] dmem_wdata;
+  wire dmem_we;
+
+  // The simulation ends as soon as any hart halts, and the core is idle only
+  // while every hart sleeps in wfi.
+  assign error = |hart_error;
+  assign idle = &hart_idle;
+
+  genvar h;
+  generate
+  for (h = 0; h < NHARTS; h = h + 1) begin : hart
+    datapath #(
+      .ENABLE_COUNTERS(ENABLE_COUNTERS),
+      .FUSION(FUSION),
+      .HART_ID(h),
+      .PROF_PERIOD(PROF_PERIOD),
+      .PC_START(PC_START),
+      .STACK_ADDR(STACK_ADDR - h * STACK_SIZE)
+    ) datapath (
+      // input
+      .clk(clk),
+      .reset(reset),
+      .stall(hart_stall[h]),
+      .imem_rdata(imem_rdata[h*XLEN +: XLEN]),
+      .imem_next_rdata(imem_next_rdata[h*XLEN +: XLEN]),
+      .dmem_rdata(bus_rdata),
+      .bus_we(dmem_we),
+      .bus_addr(dmem_addr),
+      .timer_irq(timer_irq[h]),
+
+      // output
+      .imem_addr(imem_addr[h*XLEN +: XLEN]),
+      .dmem_addr(hart_addr[h*XLEN +: XLEN]),
+      .dmem_wdata(hart_wdata[h*XLEN +: XLEN]),
+      .dmem_wmask(hart_wmask[h*XLEN +: XLEN]),
+      .dmem_re(hart_re[h]),
+      .dmem_we(hart_we[h]),
+      .prof_period(hart_prof_period[h*XLEN +: XLEN]),
+      .idle(hart_idle[h]),
+      .error(hart_error[h])
+    );
+  end
+  endgenerate
+
+  dmem_arbiter #(
+    .NPORTS(NHARTS)
+  ) dmem_arbiter (
+    // input
+    .clk(clk),
+    .reset(reset),
+    .re(hart_re),
+    .we(hart_we),
+    .addr(hart_addr),
+    .wdata(hart_wdata),
+    .wmask(hart_wmask),
+
+    // output
+    .stall(hart_stall),
+    .bus_addr(dmem_addr),
+    .bus_wdata(dmem_io_wdata),
+    .bus_wmask(dmem_wmask),
+    .bus_we(dmem_io_we)
+  );
+
+  sysbus #(
+    .NHARTS(NHARTS)
+  ) sysbus (
+    // input
+    .clk(clk),
+    .reset(reset),
+    .addr(dmem_addr),
+    .wdata(dmem_io_wdata),
+    .we(dmem_io_we),
+    .re(1'b0),
+    .dmem_rdata(dmem_rdata),
+    .prof_pc(imem_addr[0 +: XLEN]),
+    .prof_period(hart_prof_period[0 +: XLEN]),
+    .prof_en(~hart_error[0]),
+    .console_rx_valid(1'b0),
+    .console_rx_data(8'b0),
+    .console_rx_eof(1'b1),
+
+    // output
+    .rdata(bus_rdata),
+    .timer_irq(timer_irq),
+    .dmem_wdata(dmem_wdata),
+    .dmem_we(dmem_we),
+    .console_wdata(console_wdata),
+    .console_we(console_we),
+    .console_rx_ready(),
+    .test_passed(test_passed)
+  );
+
+  // IMEM_NWORDS and DMEM_NWORDS are ignored with SPARSE_MEM. With UNIFIED_MEM
+  // both ports share one memory of the larger of the two sizes.
+  generate
+  if (SPARSE_MEM) begin : mem
+    sparse_mem #(
+      .NPORTS(NHARTS)
+    ) sparse_mem (
+      // input
+      .clk(clk),
+      .reset(reset),
+      .imem_addr(imem_addr),
+      .dmem_addr(dmem_addr),
+      .dmem_wdata(dmem_wdata),
+      .dmem_wmask(dmem_wmask),
+      .dmem_we(dmem_we),
+
+      // output
+      .imem_rdata(imem_rdata),
+      .imem_next_rdata(imem_next_rdata),
+      .dmem_rdata(dmem_rdata)
+    );
+  end else if (UNIFIED_MEM) begin : mem
+    unified_mem #(
+      .NWORDS(IMEM_NWORDS > DMEM_NWORDS ? IMEM_NWORDS : DMEM_NWORDS),
+      .NPORTS(NHARTS)
+    ) unified_mem (
+      // input
+      .clk(clk),
+      .imem_addr(imem_addr),
+      .dmem_addr(dmem_addr),
+      .dmem_wdata(dmem_wdata),
+      .dmem_wmask(dmem_wmask),
+      .dmem_we(dmem_we),
+
+      // output
+      .imem_rdata(imem_rdata),
+      .imem_next_rdata(imem_next_rdata),
+      .dmem_rdata(dmem_rdata)
+    );
+  end else begin : mem
+    imem #(
+      .NWORDS(IMEM_NWORDS),
+      .NPORTS(NHARTS)
+    ) imem (
+      // input
+      .addr(imem_addr),
+
+      // output
+      .rdata(imem_rdata),
+      .next_rdata(imem_next_rdata)
+    );
+
+    dmem #(
+      .NWORDS(DMEM_NWORDS)
+    ) dmem (
+      // input
+      .clk(clk),
+      .addr(dmem_addr),
+      .wdata(dmem_wdata),
+      .wmask(dmem_wmask),
+      .we(dmem_we),
+
+      // output
+      .rdata(dmem_rdata)
+    );
+  end
+  endgenerate
+
+endmodule
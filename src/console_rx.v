@@ -0,0 +1,88 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The console receiver buffers input bytes for the core in a FIFO of DEPTH
+// entries, a power of two no less than two. `addr` is the offset into the
+// device:
+//
+//   0x0  data    reading takes the byte at the head of the FIFO, or reads as
+//                all ones if it is empty
+//   0x4  status  bit 0 is set while the FIFO holds a byte, and bit 1 once the
+//                input has ended and the FIFO has drained
+//
+// Bytes arrive through a valid/ready handshake. `in_eof` tells that no more
+// will come.
+module console_rx #(
+  parameter DEPTH = 16
+)(
+  input clk,
+  input reset,
+  input [XLEN-1:0] addr,
+  input re,
+  input in_valid,
+  input [7:0] in_data,
+  input in_eof,
+
+  output reg [XLEN-1:0] rdata,
+  output in_ready
+);
+
+  `include "constants.vh"
+
+  localparam DATA_OFFSET   = `D_XLEN'h0;
+  localparam STATUS_OFFSET = `D_XLEN'h4;
+
+  localparam PTR_LEN = (DEPTH > 1) ? $clog2(DEPTH) : 1;
+
+  reg [7:0] fifo [0:DEPTH-1];
+  reg [PTR_LEN:0] head;
+  reg [PTR_LEN:0] tail;
+
+  wire [PTR_LEN:0] count = tail - head;
+  wire empty = (count == 0);
+  wire pop = re && (addr == DATA_OFFSET) && ~empty;
+  wire push = in_valid && in_ready;
+
+  assign in_ready = (count != DEPTH);
+
+  always @(*) begin
+    case (addr)
+      DATA_OFFSET: rdata = empty ? ~(`D_XLEN'b0) : fifo[head[PTR_LEN-1:0]];
+      STATUS_OFFSET: rdata = {{(XLEN-2){1'b0}}, in_eof && empty, ~empty};
+      default: rdata = 0;
+    endcase
+  end
+
+  always @(posedge clk) begin
+    if (reset) begin
+      head <= 0;
+      tail <= 0;
+    end else begin
+      if (pop) head <= head + 1;
+      if (push) begin
+        fifo[tail[PTR_LEN-1:0]] <= in_data;
+        tail <= tail + 1;
+      end
+    end
+  end
+
+endmodule
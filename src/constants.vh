@@ -21,17 +21,19 @@
 
 
 `define D_XLEN 32
-`define D_ALU_OP_LEN 4
+`define D_ALU_OP_LEN 6
 `define D_SRCA_SEL_LEN 2
 `define D_SRCB_SEL_LEN 3
 `define D_PC_SEL_LEN 3
 `define D_REG_ADDR_LEN 5
-`define D_WB_SEL_LEN 2
+`define D_WB_SEL_LEN 3
 `define D_MEM_TYPE_LEN 3
 `define D_CSR_COUNTER_LEN 64
 `define D_CSR_SEL_LEN 1
 `define D_CSR_ADDR_LEN 12
 `define D_CSR_CMD_LEN 2
+`define D_AMO_OP_LEN 4
+`define D_PIPE_EVENT_LEN 3
 
 localparam XLEN = `D_XLEN;
 localparam REG_ADDR_LEN = `D_REG_ADDR_LEN;
@@ -42,21 +44,44 @@ localparam PC_SEL_LEN   = `D_PC_SEL_LEN,
            PC_JAL       = `D_PC_SEL_LEN'd2,
            PC_JALR      = `D_PC_SEL_LEN'd3;
 
-localparam ALU_OP_LEN = `D_ALU_OP_LEN,
-           ALU_ADD    = `D_ALU_OP_LEN'd0,
-           ALU_SLL    = `D_ALU_OP_LEN'd1,
-           ALU_XOR    = `D_ALU_OP_LEN'd2,
-           ALU_OR     = `D_ALU_OP_LEN'd3,
-           ALU_AND    = `D_ALU_OP_LEN'd4,
-           ALU_SRL    = `D_ALU_OP_LEN'd5,
-           ALU_SEQ    = `D_ALU_OP_LEN'd6,
-           ALU_SNE    = `D_ALU_OP_LEN'd7,
-           ALU_SUB    = `D_ALU_OP_LEN'd8,
-           ALU_SRA    = `D_ALU_OP_LEN'd9,
-           ALU_SLT    = `D_ALU_OP_LEN'd10,
-           ALU_SGE    = `D_ALU_OP_LEN'd11,
-           ALU_SLTU   = `D_ALU_OP_LEN'd12,
-           ALU_SGEU   = `D_ALU_OP_LEN'd13;
+localparam ALU_OP_LEN   = `D_ALU_OP_LEN,
+           ALU_ADD      = `D_ALU_OP_LEN'd0,
+           ALU_SLL      = `D_ALU_OP_LEN'd1,
+           ALU_XOR      = `D_ALU_OP_LEN'd2,
+           ALU_OR       = `D_ALU_OP_LEN'd3,
+           ALU_AND      = `D_ALU_OP_LEN'd4,
+           ALU_SRL      = `D_ALU_OP_LEN'd5,
+           ALU_SEQ      = `D_ALU_OP_LEN'd6,
+           ALU_SNE      = `D_ALU_OP_LEN'd7,
+           ALU_SUB      = `D_ALU_OP_LEN'd8,
+           ALU_SRA      = `D_ALU_OP_LEN'd9,
+           ALU_SLT      = `D_ALU_OP_LEN'd10,
+           ALU_SGE      = `D_ALU_OP_LEN'd11,
+           ALU_SLTU     = `D_ALU_OP_LEN'd12,
+           ALU_SGEU     = `D_ALU_OP_LEN'd13,
+           ALU_ADD8     = `D_ALU_OP_LEN'd14,
+           ALU_ADD16    = `D_ALU_OP_LEN'd15,
+           ALU_SUB8     = `D_ALU_OP_LEN'd16,
+           ALU_SUB16    = `D_ALU_OP_LEN'd17,
+           ALU_CMPEQ8   = `D_ALU_OP_LEN'd18,
+           ALU_CMPEQ16  = `D_ALU_OP_LEN'd19,
+           ALU_SCMPLT8  = `D_ALU_OP_LEN'd20,
+           ALU_SCMPLT16 = `D_ALU_OP_LEN'd21,
+           ALU_SCMPLE8  = `D_ALU_OP_LEN'd22,
+           ALU_SCMPLE16 = `D_ALU_OP_LEN'd23,
+           ALU_UCMPLT8  = `D_ALU_OP_LEN'd24,
+           ALU_UCMPLT16 = `D_ALU_OP_LEN'd25,
+           ALU_UCMPLE8  = `D_ALU_OP_LEN'd26,
+           ALU_UCMPLE16 = `D_ALU_OP_LEN'd27,
+           ALU_SMIN8    = `D_ALU_OP_LEN'd28,
+           ALU_SMIN16   = `D_ALU_OP_LEN'd29,
+           ALU_SMAX8    = `D_ALU_OP_LEN'd30,
+           ALU_SMAX16   = `D_ALU_OP_LEN'd31,
+           ALU_UMIN8    = `D_ALU_OP_LEN'd32,
+           ALU_UMIN16   = `D_ALU_OP_LEN'd33,
+           ALU_UMAX8    = `D_ALU_OP_LEN'd34,
+           ALU_UMAX16   = `D_ALU_OP_LEN'd35,
+           ALU_PBSAD    = `D_ALU_OP_LEN'd36;
 
 localparam SRCA_SEL_LEN = `D_SRCA_SEL_LEN,
            SRCA_RS1     = `D_SRCA_SEL_LEN'd0,
@@ -84,7 +109,9 @@ localparam MEM_TYPE_LEN = `D_MEM_TYPE_LEN,
 localparam WB_SEL_LEN = `D_WB_SEL_LEN,
            WB_ALU     = `D_WB_SEL_LEN'd0,
            WB_MEM     = `D_WB_SEL_LEN'd1,
-           WB_CSR     = `D_WB_SEL_LEN'd2;
+           WB_CSR     = `D_WB_SEL_LEN'd2,
+           WB_SC      = `D_WB_SEL_LEN'd3,
+           WB_CUSTOM  = `D_WB_SEL_LEN'd4;
 
 localparam RV_NOP     = `D_XLEN'b0010011,
            RV_INVALID = `D_XLEN'b0;
@@ -100,10 +127,56 @@ localparam CSR_COUNTER_LEN   = `D_CSR_COUNTER_LEN,
            CSR_ADDR_INSTRET  = `D_CSR_ADDR_LEN'hC02,
            CSR_ADDR_CYCLEH   = `D_CSR_ADDR_LEN'hC80,
            CSR_ADDR_TIMEH    = `D_CSR_ADDR_LEN'hC81,
-           CSR_ADDR_INSTRETH = `D_CSR_ADDR_LEN'hC82;
+           CSR_ADDR_INSTRETH = `D_CSR_ADDR_LEN'hC82,
+           CSR_ADDR_MHARTID  = `D_CSR_ADDR_LEN'hF14,
+           CSR_ADDR_MSTATUS  = `D_CSR_ADDR_LEN'h300,
+           CSR_ADDR_MIE      = `D_CSR_ADDR_LEN'h304,
+           CSR_ADDR_MTVEC    = `D_CSR_ADDR_LEN'h305,
+           CSR_ADDR_MSCRATCH = `D_CSR_ADDR_LEN'h340,
+           CSR_ADDR_MEPC     = `D_CSR_ADDR_LEN'h341,
+           CSR_ADDR_MCAUSE   = `D_CSR_ADDR_LEN'h342,
+           CSR_ADDR_MTVAL    = `D_CSR_ADDR_LEN'h343,
+           CSR_ADDR_MIP      = `D_CSR_ADDR_LEN'h344,
+           CSR_ADDR_MPROF    = `D_CSR_ADDR_LEN'h7C0,
+           CSR_ADDR_MREGION  = `D_CSR_ADDR_LEN'h7C1,
+           CSR_ADDR_MFUSED   = `D_CSR_ADDR_LEN'hFC0;
+
+localparam MSTATUS_MIE  = 3,
+           MSTATUS_MPIE = 7,
+           MIP_MTIP     = 7;
+
+localparam CAUSE_MISALIGNED_FETCH = `D_XLEN'd0,
+           CAUSE_ILLEGAL_INST     = `D_XLEN'd2,
+           CAUSE_MISALIGNED_LOAD  = `D_XLEN'd4,
+           CAUSE_MISALIGNED_STORE = `D_XLEN'd6,
+           CAUSE_ECALL_M          = `D_XLEN'd11,
+           CAUSE_IRQ_M_TIMER      = `D_XLEN'h8000_0007;
 
 localparam CSR_CMD_LEN = `D_CSR_CMD_LEN,
            CSR_READ    = `D_CSR_CMD_LEN'd0,
            CSR_WRITE   = `D_CSR_CMD_LEN'd1,
            CSR_SET     = `D_CSR_CMD_LEN'd2,
            CSR_CLEAR   = `D_CSR_CMD_LEN'd3;
+
+localparam AMO_OP_LEN = `D_AMO_OP_LEN,
+           AMO_NONE   = `D_AMO_OP_LEN'd0,
+           AMO_LR     = `D_AMO_OP_LEN'd1,
+           AMO_SC     = `D_AMO_OP_LEN'd2,
+           AMO_SWAP   = `D_AMO_OP_LEN'd3,
+           AMO_ADD    = `D_AMO_OP_LEN'd4,
+           AMO_XOR    = `D_AMO_OP_LEN'd5,
+           AMO_AND    = `D_AMO_OP_LEN'd6,
+           AMO_OR     = `D_AMO_OP_LEN'd7,
+           AMO_MIN    = `D_AMO_OP_LEN'd8,
+           AMO_MAX    = `D_AMO_OP_LEN'd9,
+           AMO_MINU   = `D_AMO_OP_LEN'd10,
+           AMO_MAXU   = `D_AMO_OP_LEN'd11;
+
+localparam PIPE_EVENT_LEN = `D_PIPE_EVENT_LEN,
+           PIPE_RETIRE    = `D_PIPE_EVENT_LEN'd0,
+           PIPE_STALL     = `D_PIPE_EVENT_LEN'd1,
+           PIPE_SLEEP     = `D_PIPE_EVENT_LEN'd2,
+           PIPE_IRQ       = `D_PIPE_EVENT_LEN'd3,
+           PIPE_EXCEPTION = `D_PIPE_EVENT_LEN'd4,
+           PIPE_HALT      = `D_PIPE_EVENT_LEN'd5,
+           PIPE_HALTED    = `D_PIPE_EVENT_LEN'd6;
@@ -21,7 +21,10 @@
 
 
 // The control unit takes an instruction, decodes it, and sends control signals
-// to the datapath.
+// to the datapath. Instructions it cannot decode are flagged as illegal.
+// Custom opcodes are flagged with `custom` and decoded by the custom unit.
+// `wfi` is raised for the wait-for-interrupt instruction, which the datapath
+// holds until an interrupt is pending.
 module control (
   input reset,
   input [XLEN-1:0] inst,
@@ -30,13 +33,20 @@ module control (
   output reg [SRCA_SEL_LEN-1:0] alu_srca,
   output reg [SRCB_SEL_LEN-1:0] alu_srcb,
   output wire [MEM_TYPE_LEN-1:0] dmem_type,
+  output reg dmem_re,
   output reg dmem_we,
+  output reg [AMO_OP_LEN-1:0] amo_op,
   output reg reg_we,
   output reg [WB_SEL_LEN-1:0] wb_sel,
   output reg [CSR_CMD_LEN-1:0] csr_cmd,
   output reg [CSR_SEL_LEN-1:0] csr_sel,
   output reg [PC_SEL_LEN-1:0] pc_sel,
-  output reg error
+  output reg ecall,
+  output reg ebreak,
+  output reg mret,
+  output reg wfi,
+  output reg custom,
+  output reg illegal
 );
 
   `include "constants.vh"
@@ -45,6 +55,8 @@ module control (
   wire [6:0] opcode = inst[6:0];
   wire [2:0] funct3 = inst[14:12];
   wire [6:0] funct7 = inst[31:25];
+  wire [4:0] funct5 = inst[31:27];
+  wire [11:0] funct12 = inst[31:20];
   wire [REG_ADDR_LEN-1:0] rs1_addr = inst[19:15];
 
   reg [ALU_OP_LEN-1:0] alu_op_arith;
@@ -53,18 +65,24 @@ module control (
     alu_op = ALU_ADD;
     alu_srca = SRCA_RS1;
     alu_srcb = SRCB_IMM_I;
+    dmem_re = 1'b0;
     dmem_we = 1'b0;
+    amo_op = AMO_NONE;
     reg_we = 1'b0;
     wb_sel = WB_ALU;
     csr_sel = CSR_SEL_RS1;
     csr_cmd = CSR_READ;
     pc_sel = PC_PLUS_FOUR;
-    if (reset) begin
-      error = 1'b0;
-    end
+    ecall = 1'b0;
+    ebreak = 1'b0;
+    mret = 1'b0;
+    wfi = 1'b0;
+    custom = 1'b0;
+    illegal = 1'b0;
 
     case (opcode)
       RV_LOAD: begin
+        dmem_re = 1'b1;
         reg_we = 1'b1;
         wb_sel = WB_MEM;
       end
@@ -83,7 +101,7 @@ module control (
           RV_FUNCT3_BGE: alu_op = ALU_SGE;
           RV_FUNCT3_BGEU: alu_op = ALU_SGEU;
           default: begin
-            error = 1'b1;
+            illegal = 1'b1;
           end
         endcase
       end
@@ -95,7 +113,7 @@ module control (
       end
       RV_JALR: begin
         if (funct3 != 0) begin
-          error = 1'b1;
+          illegal = 1'b1;
         end
         pc_sel = PC_JALR;
         alu_srca = SRCA_PC;
@@ -111,11 +129,96 @@ module control (
         alu_srcb = SRCB_RS2;
         reg_we = 1'b1;
       end
+      RV_OP_P: begin
+        alu_srcb = SRCB_RS2;
+        reg_we = 1'b1;
+        if (funct3 != 0) begin
+          illegal = 1'b1;
+        end
+        case (funct7)
+          RV_FUNCT7_ADD8: alu_op = ALU_ADD8;
+          RV_FUNCT7_ADD16: alu_op = ALU_ADD16;
+          RV_FUNCT7_SUB8: alu_op = ALU_SUB8;
+          RV_FUNCT7_SUB16: alu_op = ALU_SUB16;
+          RV_FUNCT7_CMPEQ8: alu_op = ALU_CMPEQ8;
+          RV_FUNCT7_CMPEQ16: alu_op = ALU_CMPEQ16;
+          RV_FUNCT7_SCMPLT8: alu_op = ALU_SCMPLT8;
+          RV_FUNCT7_SCMPLT16: alu_op = ALU_SCMPLT16;
+          RV_FUNCT7_SCMPLE8: alu_op = ALU_SCMPLE8;
+          RV_FUNCT7_SCMPLE16: alu_op = ALU_SCMPLE16;
+          RV_FUNCT7_UCMPLT8: alu_op = ALU_UCMPLT8;
+          RV_FUNCT7_UCMPLT16: alu_op = ALU_UCMPLT16;
+          RV_FUNCT7_UCMPLE8: alu_op = ALU_UCMPLE8;
+          RV_FUNCT7_UCMPLE16: alu_op = ALU_UCMPLE16;
+          RV_FUNCT7_SMIN8: alu_op = ALU_SMIN8;
+          RV_FUNCT7_SMIN16: alu_op = ALU_SMIN16;
+          RV_FUNCT7_SMAX8: alu_op = ALU_SMAX8;
+          RV_FUNCT7_SMAX16: alu_op = ALU_SMAX16;
+          RV_FUNCT7_UMIN8: alu_op = ALU_UMIN8;
+          RV_FUNCT7_UMIN16: alu_op = ALU_UMIN16;
+          RV_FUNCT7_UMAX8: alu_op = ALU_UMAX8;
+          RV_FUNCT7_UMAX16: alu_op = ALU_UMAX16;
+          RV_FUNCT7_PBSAD: alu_op = ALU_PBSAD;
+          default: begin
+            illegal = 1'b1;
+          end
+        endcase
+      end
+      RV_MISC_MEM: begin
+        // Memory accesses complete in program order, so fences are no-ops.
+      end
+      RV_AMO: begin
+        // The address comes straight from rs1 and the old memory value is
+        // written back to rd.
+        alu_srcb = SRCB_ZERO;
+        dmem_re = 1'b1;
+        dmem_we = 1'b1;
+        reg_we = 1'b1;
+        wb_sel = WB_MEM;
+        if (funct3 != RV_FUNCT3_AMO_W) begin
+          illegal = 1'b1;
+        end
+        case (funct5)
+          RV_FUNCT5_LR: begin
+            amo_op = AMO_LR;
+            dmem_we = 1'b0;
+          end
+          RV_FUNCT5_SC: begin
+            amo_op = AMO_SC;
+            wb_sel = WB_SC;
+          end
+          RV_FUNCT5_AMOSWAP: amo_op = AMO_SWAP;
+          RV_FUNCT5_AMOADD: amo_op = AMO_ADD;
+          RV_FUNCT5_AMOXOR: amo_op = AMO_XOR;
+          RV_FUNCT5_AMOAND: amo_op = AMO_AND;
+          RV_FUNCT5_AMOOR: amo_op = AMO_OR;
+          RV_FUNCT5_AMOMIN: amo_op = AMO_MIN;
+          RV_FUNCT5_AMOMAX: amo_op = AMO_MAX;
+          RV_FUNCT5_AMOMINU: amo_op = AMO_MINU;
+          RV_FUNCT5_AMOMAXU: amo_op = AMO_MAXU;
+          default: illegal = 1'b1;
+        endcase
+      end
       RV_SYSTEM: begin
         // Only a few CSR instructions are implemented for RV_SYSTEM
         wb_sel = WB_CSR;
         reg_we = 1'b1;
         case (funct3)
+          RV_FUNCT3_PRIV: begin
+            // rs1 and rd must be x0 as well
+            reg_we = 1'b0;
+            if (inst[19:7] != 0) begin
+              illegal = 1'b1;
+            end else begin
+              case (funct12)
+                RV_FUNCT12_ECALL: ecall = 1'b1;
+                RV_FUNCT12_EBREAK: ebreak = 1'b1;
+                RV_FUNCT12_MRET: mret = 1'b1;
+                RV_FUNCT12_WFI: wfi = 1'b1;
+                default: illegal = 1'b1;
+              endcase
+            end
+          end
           RV_FUNCT3_CSRRW: begin
             csr_cmd = CSR_WRITE;
           end
@@ -137,9 +240,16 @@ module control (
             csr_cmd = CSR_CLEAR;
             csr_sel = CSR_SEL_IMM;
           end
-          default: error = 1'b1;
+          default: illegal = 1'b1;
         endcase
-        if (rs1_addr == 0) csr_cmd = CSR_READ;
+        // csrrs and csrrc with x0, and their immediate forms with zero, only
+        // read. csrrw and csrrwi always write.
+        if (rs1_addr == 0 && csr_cmd != CSR_WRITE) csr_cmd = CSR_READ;
+      end
+      RV_CUSTOM_0, RV_CUSTOM_1: begin
+        reg_we = 1'b1;
+        wb_sel = WB_CUSTOM;
+        custom = 1'b1;
       end
       RV_AUIPC: begin
         alu_srca = SRCA_PC;
@@ -152,7 +262,7 @@ module control (
         reg_we = 1'b1;
       end
       default: begin
-        error = 1'b1;
+        illegal = 1'b1;
       end
     endcase
   end
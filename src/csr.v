@@ -20,15 +20,54 @@
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
-// This module contains a few performance counters.
-module csr (
+// This module contains a few performance counters, the machine information
+// registers and the machine trap registers. The counters read as zero when
+// ENABLE_COUNTERS is not set.
+//
+// `trap` records a trap taken on the instruction at `trap_pc` and disables
+// interrupts. `mret` restores the interrupt enable saved by the last trap.
+// `wake` is raised while an interrupt enabled in mie is pending, whether or not
+// mstatus masks it, and ends a wfi.
+//
+// The custom mprof register holds the sampling period of the profiler in
+// cycles. Zero turns the profiler off.
+//
+// Writes to the custom mregion register mark the beginning (bit 0 set) or the
+// end (bit 0 clear) of the timing region numbered by the upper bits. They have
+// no effect on the core. Verilator testbenches receive them together with the
+// counters through the region_mark DPI import, and the register reads as zero.
+//
+// The custom read-only mfused register counts the instruction pairs the
+// fusion unit executed in a single cycle. `fused` marks such a retirement,
+// which also advances instret by two.
+//
+// While every hart sleeps in wfi, Verilator testbenches advance the counters
+// over the idle cycles at once through the exported csr_skip.
+module csr #(
+  parameter ENABLE_COUNTERS = 1,
+  parameter HART_ID         = 0,
+  parameter PROF_PERIOD     = 0
+)(
   input clk,
   input reset,
+  input retire,
+  input fused,
   input [CSR_CMD_LEN-1:0] cmd,
   input [CSR_ADDR_LEN-1:0] addr,
   input [XLEN-1:0] wdata,
+  input timer_irq,
+  input trap,
+  input [XLEN-1:0] trap_cause,
+  input [XLEN-1:0] trap_pc,
+  input [XLEN-1:0] trap_val,
+  input mret,
 
-  output reg [XLEN-1:0] rdata
+  output reg [XLEN-1:0] rdata,
+  output reg [XLEN-1:0] mtvec,
+  output reg [XLEN-1:0] mepc,
+  output reg [XLEN-1:0] prof_period,
+  output irq_pending,
+  output wake
 );
 
   `include "constants.vh"
@@ -36,9 +75,26 @@ module csr (
   reg [CSR_COUNTER_LEN-1:0] cycle_cnt;
   reg [CSR_COUNTER_LEN-1:0] time_cnt;
   reg [CSR_COUNTER_LEN-1:0] instret;
+  reg [XLEN-1:0] fused_cnt;
   reg [XLEN-1:0] to_write;
   reg we;
 
+  reg mstatus_mie;
+  reg mstatus_mpie;
+  reg mie_mtie;
+  reg [XLEN-1:0] mscratch;
+  reg [XLEN-1:0] mcause;
+  reg [XLEN-1:0] mtval;
+
+  // MPP is hardwired to machine mode.
+  wire [XLEN-1:0] mstatus = (`D_XLEN'b11 << 11) | (mstatus_mpie << MSTATUS_MPIE) |
+                            (mstatus_mie << MSTATUS_MIE);
+  wire [XLEN-1:0] mie = mie_mtie << MIP_MTIP;
+  wire [XLEN-1:0] mip = timer_irq << MIP_MTIP;
+
+  assign irq_pending = mstatus_mie && mie_mtie && timer_irq;
+  assign wake = mie_mtie && timer_irq;
+
   always @(*) begin
     case (cmd)
       CSR_WRITE: begin
@@ -68,20 +124,33 @@ module csr (
       CSR_ADDR_CYCLEH: rdata = cycle_cnt[XLEN +: XLEN];
       CSR_ADDR_TIMEH: rdata = time_cnt[XLEN +: XLEN];
       CSR_ADDR_INSTRETH: rdata = instret[XLEN +: XLEN];
+      CSR_ADDR_MHARTID: rdata = HART_ID;
+      CSR_ADDR_MSTATUS: rdata = mstatus;
+      CSR_ADDR_MIE: rdata = mie;
+      CSR_ADDR_MTVEC: rdata = mtvec;
+      CSR_ADDR_MSCRATCH: rdata = mscratch;
+      CSR_ADDR_MEPC: rdata = mepc;
+      CSR_ADDR_MCAUSE: rdata = mcause;
+      CSR_ADDR_MTVAL: rdata = mtval;
+      CSR_ADDR_MIP: rdata = mip;
+      CSR_ADDR_MPROF: rdata = prof_period;
+      CSR_ADDR_MFUSED: rdata = fused_cnt;
       default: rdata = 0;
     endcase
   end
 
   always @(posedge clk) begin
-    if (reset) begin
+    if (reset || !ENABLE_COUNTERS) begin
       cycle_cnt <= 0;
       time_cnt <= 0;
       instret <= 0;
+      fused_cnt <= 0;
     end else begin
       cycle_cnt <= cycle_cnt + 1;
       time_cnt <= time_cnt + 1;
-      instret <= instret + 1;
-      if (we) begin
+      if (retire) instret <= instret + (fused ? 2 : 1);
+      if (retire && fused) fused_cnt <= fused_cnt + 1;
+      if (we && retire) begin
         case (addr)
           CSR_ADDR_CYCLE: cycle_cnt[0 +: XLEN] <= to_write;
           CSR_ADDR_TIME: time_cnt[0 +: XLEN] <= to_write;
@@ -91,8 +160,72 @@ module csr (
           CSR_ADDR_INSTRETH: instret[XLEN +: XLEN] <= to_write;
           default: ;
         endcase
+      end // if (we && retire)
+    end // if (reset)
+  end // always @(posedge clk)
+
+  always @(posedge clk) begin
+    if (reset) begin
+      mstatus_mie <= 1'b0;
+      mstatus_mpie <= 1'b0;
+      mie_mtie <= 1'b0;
+      mtvec <= 0;
+      mepc <= 0;
+      mcause <= 0;
+      mtval <= 0;
+      prof_period <= PROF_PERIOD;
+    end else if (trap) begin
+      mstatus_mie <= 1'b0;
+      mstatus_mpie <= mstatus_mie;
+      mepc <= trap_pc;
+      mcause <= trap_cause;
+      mtval <= trap_val;
+    end else if (retire) begin
+      if (mret) begin
+        mstatus_mie <= mstatus_mpie;
+        mstatus_mpie <= 1'b1;
+      end
+      if (we) begin
+        case (addr)
+          CSR_ADDR_MSTATUS: begin
+            mstatus_mie <= to_write[MSTATUS_MIE];
+            mstatus_mpie <= to_write[MSTATUS_MPIE];
+          end
+          CSR_ADDR_MIE: mie_mtie <= to_write[MIP_MTIP];
+          CSR_ADDR_MTVEC: mtvec <= {to_write[XLEN-1:2], 1'b0, to_write[0]};
+          CSR_ADDR_MSCRATCH: mscratch <= to_write;
+          CSR_ADDR_MEPC: mepc <= {to_write[XLEN-1:2], 2'b0};
+          CSR_ADDR_MCAUSE: mcause <= to_write;
+          CSR_ADDR_MTVAL: mtval <= to_write;
+          CSR_ADDR_MPROF: prof_period <= to_write;
+          default: ;
+        endcase
       end // if (we)
     end // if (reset)
   end // always @(posedge clk)
 
+`ifdef VERILATOR
+  import "DPI-C" function void region_mark(input int hart, input int value,
+                                           input longint cycle,
+                                           input longint instret);
+
+  always @(posedge clk) begin
+    if (~reset && we && retire && (addr == CSR_ADDR_MREGION)) begin
+      region_mark(HART_ID, to_write, cycle_cnt, instret);
+    end
+  end
+
+  import "DPI-C" context function void idle_register_csr();
+  export "DPI-C" function csr_skip;
+
+  initial idle_register_csr();
+
+  function void csr_skip(input longint cycles);
+    if (ENABLE_COUNTERS) begin
+      cycle_cnt = cycle_cnt + cycles;
+      time_cnt = time_cnt + cycles;
+    end
+  endfunction
+`endif
+
 endmodule
@@ -0,0 +1,75 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The custom unit executes the custom-0 and custom-1 opcodes by dispatching
+// them to the functional units attached to it. Every unit takes rs1 and rs2
+// and produces its result in the same cycle, like the ALU. A unit owns an
+// opcode and flags the funct3/funct7 encodings it does not implement, and
+// opcodes without a unit are illegal.
+//
+// custom-0: puzzle_unit
+// custom-1: none
+module custom (
+  input [XLEN-1:0] inst,
+  input [XLEN-1:0] rs1,
+  input [XLEN-1:0] rs2,
+
+  output reg [XLEN-1:0] out,
+  output reg illegal
+);
+
+  `include "constants.vh"
+  `include "rv_constants.vh"
+
+  wire [6:0] opcode = inst[6:0];
+  wire [2:0] funct3 = inst[14:12];
+  wire [6:0] funct7 = inst[31:25];
+
+  wire [XLEN-1:0] puzzle_out;
+  wire puzzle_illegal;
+
+  puzzle_unit puzzle_unit (
+    // input
+    .funct3(funct3),
+    .funct7(funct7),
+    .rs1(rs1),
+    .rs2(rs2),
+
+    // output
+    .out(puzzle_out),
+    .illegal(puzzle_illegal)
+  );
+
+  always @(*) begin
+    case (opcode)
+      RV_CUSTOM_0: begin
+        out = puzzle_out;
+        illegal = puzzle_illegal;
+      end
+      default: begin
+        out = 0;
+        illegal = 1'b1;
+      end
+    endcase
+  end
+
+endmodule
@@ -21,31 +21,67 @@
 
 
 // The datapath is where data flows through and is processed.
+//
+// When `stall` is asserted the current instruction is held and none of its
+// side effects take place. `bus_we` and `bus_addr` describe the store that the
+// data memory performs in the current cycle, which may come from another hart,
+// and are used to break LR/SC reservations.
+//
+// Exceptions and the timer interrupt trap to mtvec. While mtvec is zero no
+// handler is installed, so exceptions halt the core instead. ebreak is not a
+// breakpoint exception: it always halts the core, handler or not, since it is
+// how programs end. `error` is raised once the core has halted.
+//
+// With FUSION set, pairs of instructions recognized by the fusion unit retire
+// together in one cycle. The second instruction is fetched from
+// `imem_next_rdata`, the word after the one at `imem_addr`.
+//
+// wfi holds the pc without retiring until an interrupt enabled in mie is
+// pending, and `idle` is raised meanwhile. If the interrupt is taken, mepc
+// points past the wfi.
 module datapath #(
   parameter ENABLE_COUNTERS = 1,
+  parameter FUSION          = 1,
+  parameter HART_ID         = 0,
+  parameter PROF_PERIOD     = 0,
   parameter PC_START        = `D_XLEN'h0,
   parameter STACK_ADDR      = ~(`D_XLEN'h0)
 )(
   input clk,
   input reset,
+  input stall,
   input [XLEN-1:0] imem_rdata,
+  input [XLEN-1:0] imem_next_rdata,
   input [XLEN-1:0] dmem_rdata,
+  input bus_we,
+  input [XLEN-1:0] bus_addr,
+  input timer_irq,
 
   output [XLEN-1:0] imem_addr,
   output [XLEN-1:0] dmem_addr,
   output [XLEN-1:0] dmem_wdata,
   output reg [XLEN-1:0] dmem_wmask,
+  output dmem_re,
   output dmem_we,
-  output error
+  output [XLEN-1:0] prof_period,
+  output idle,
+  output reg error
 );
 
   `include "constants.vh"
 
   wire branch;
   wire [PC_SEL_LEN-1:0] pc_sel;
-  wire [XLEN-1:0] pc_next;
+  wire [XLEN-1:0] pc_target;
+  reg [XLEN-1:0] pc_next;
   reg [XLEN-1:0] pc;
-  reg [XLEN-1:0] inst;
+  reg [XLEN-1:0] fetched;
+
+  // The instruction executed in this cycle, which is the second of the pair
+  // when fused, and the pc it executes at.
+  wire fused;
+  wire [XLEN-1:0] inst = fused ? imem_next_rdata : fetched;
+  wire [XLEN-1:0] exec_pc = fused ? pc + 4 : pc;
 
   wire [XLEN-1:0] imm_i = {{21{inst[31]}}, inst[30:20]};
   wire [XLEN-1:0] imm_s = {{21{inst[31]}}, inst[30:25], inst[11:7]};
@@ -55,11 +91,18 @@ module datapath #(
 
   wire [XLEN-1:0] rs1_data;
   wire [XLEN-1:0] rs2_data;
+  wire [XLEN-1:0] reg_rs1_data;
+  wire [XLEN-1:0] first_out;
+  wire [REG_ADDR_LEN-1:0] fused_rs2_addr;
   wire [ALU_OP_LEN-1:0] alu_op;
   wire [SRCA_SEL_LEN-1:0] srca_sel;
   wire [SRCB_SEL_LEN-1:0] srcb_sel;
 
   wire [MEM_TYPE_LEN-1:0] dmem_type;
+  wire [AMO_OP_LEN-1:0] amo_op;
+  wire dmem_load;
+  wire dmem_store;
+  wire sc_ok;
 
   wire reg_we;
   wire [WB_SEL_LEN-1:0] wb_sel;
@@ -69,6 +112,48 @@ module datapath #(
   wire [CSR_SEL_LEN-1:0] csr_sel;
   wire [XLEN-1:0] csr_rdata;
 
+  wire ecall;
+  wire ebreak;
+  wire mret;
+  wire wfi;
+  wire wake;
+  wire custom_inst;
+  wire decode_illegal;
+  wire custom_illegal;
+  wire illegal = decode_illegal || (custom_inst && custom_illegal);
+  wire [XLEN-1:0] mtvec;
+  wire [XLEN-1:0] mepc;
+  wire irq_pending;
+
+  // A pending interrupt, an exception or ebreak cancels every side effect of
+  // the current instruction.
+  reg exception;
+  reg [XLEN-1:0] cause;
+  reg [XLEN-1:0] tval;
+  wire has_handler = (mtvec != 0);
+  wire kill = irq_pending || exception || ebreak;
+  wire trap = ~stall && ~error && (irq_pending || (exception && has_handler));
+  wire halt = ~irq_pending && (ebreak || (exception && ~has_handler));
+  wire sleep = wfi && ~wake;
+  wire retire = ~stall && ~error && ~kill && ~sleep;
+
+  assign idle = sleep && ~error;
+
+  // What becomes of the instruction at pc in this cycle, for the pipeline log
+  // of the testbenches: it retires, stalls on the data memory, sleeps in wfi,
+  // is flushed by an interrupt or an exception, or halts the core.
+  reg [PIPE_EVENT_LEN-1:0] pipe_event;
+
+  always @(*) begin
+    if (error) pipe_event = PIPE_HALTED;
+    else if (stall) pipe_event = PIPE_STALL;
+    else if (irq_pending) pipe_event = PIPE_IRQ;
+    else if (halt) pipe_event = PIPE_HALT;
+    else if (exception) pipe_event = PIPE_EXCEPTION;
+    else if (sleep) pipe_event = PIPE_SLEEP;
+    else pipe_event = PIPE_RETIRE;
+  end
+
 
   control control (
     // input
@@ -80,18 +165,25 @@ module datapath #(
     .alu_srca(srca_sel),
     .alu_srcb(srcb_sel),
     .dmem_type(dmem_type),
-    .dmem_we(dmem_we),
+    .dmem_re(dmem_load),
+    .dmem_we(dmem_store),
+    .amo_op(amo_op),
     .reg_we(reg_we),
     .wb_sel(wb_sel),
     .csr_cmd(csr_cmd),
     .csr_sel(csr_sel),
     .pc_sel(pc_sel),
-    .error(error)
+    .ecall(ecall),
+    .ebreak(ebreak),
+    .mret(mret),
+    .wfi(wfi),
+    .custom(custom_inst),
+    .illegal(decode_illegal)
   );
 
   pc_mux pc_mux (
     // input
-    .pc_in(pc),
+    .pc_in(exec_pc),
     .sel(pc_sel),
     .branch(branch),
     .imm_i(imm_i),
@@ -100,7 +192,7 @@ module datapath #(
     .rs1_data(rs1_data),
 
     //output
-    .pc_out(pc_next)
+    .pc_out(pc_target)
   );
 
 
@@ -109,21 +201,57 @@ module datapath #(
   assign imem_addr = pc;
 
   always @(*) begin
-    if (reset) inst = RV_NOP;
-    else if (error) inst = RV_INVALID;
-    else inst = imem_rdata;
+    if (reset) fetched = RV_NOP;
+    else if (error) fetched = RV_INVALID;
+    else fetched = imem_rdata;
+  end
+
+  wire fusable;
+
+  fusion fusion (
+    // input
+    .pc(pc),
+    .inst(fetched),
+    .next_inst(imem_next_rdata),
+    .rs1_data(reg_rs1_data),
+
+    // output
+    .fused(fusable),
+    .first_out(first_out),
+    .rs2_addr(fused_rs2_addr)
+  );
+
+  assign fused = FUSION && ~reset && ~error && fusable;
+
+  // In vectored mode interrupts jump to base + 4 * cause. The interrupt bit of
+  // the cause is shifted out.
+  wire [XLEN-1:0] trap_base = {mtvec[XLEN-1:2], 2'b0};
+  wire [XLEN-1:0] trap_vector = (mtvec[0] && irq_pending) ?
+                                trap_base + (CAUSE_IRQ_M_TIMER << 2) : trap_base;
+
+  always @(*) begin
+    if (trap) pc_next = trap_vector;
+    else if (mret) pc_next = mepc;
+    else pc_next = pc_target;
   end
 
   always @(posedge clk) begin
     if (reset) pc <= PC_START;
-    else if (~error) pc <= pc_next;
+    else if (~error && ~stall && ~halt && ~sleep) pc <= pc_next;
+  end
+
+  always @(posedge clk) begin
+    if (reset) error <= 1'b0;
+    else if (~stall && halt) error <= 1'b1;
   end
 
 
   // Execute
 
-  wire [REG_ADDR_LEN-1:0] rs1_addr = inst[19:15];
-  wire [REG_ADDR_LEN-1:0] rs2_addr = inst[24:20];
+  // rs1 of the first instruction is read for slli, and the result of the
+  // first instruction stands in for rs1 of the second.
+  wire [REG_ADDR_LEN-1:0] rs1_addr = fetched[19:15];
+  wire [REG_ADDR_LEN-1:0] rs2_addr = fused ? fused_rs2_addr : inst[24:20];
   wire [REG_ADDR_LEN-1:0] rd_addr = inst[11:7];
 
   regfile #(
@@ -135,14 +263,16 @@ module datapath #(
     .ra1(rs1_addr),
     .ra2(rs2_addr),
     .wa(rd_addr),
-    .we(reg_we),
+    .we(reg_we & retire),
     .wdata(reg_wdata),
 
     // output
-    .rd1(rs1_data),
+    .rd1(reg_rs1_data),
     .rd2(rs2_data)
   );
 
+  assign rs1_data = fused ? first_out : reg_rs1_data;
+
   wire [XLEN-1:0] alu_srca;
   wire [XLEN-1:0] alu_srcb;
 
@@ -152,7 +282,7 @@ module datapath #(
     .srcb_sel(srcb_sel),
     .rs1(rs1_data),
     .rs2(rs2_data),
-    .pc(pc),
+    .pc(exec_pc),
     .imm_i(imm_i),
     .imm_s(imm_s),
     .imm_u(imm_u),
@@ -176,6 +306,19 @@ module datapath #(
     .out(alu_out)
   );
 
+  wire [XLEN-1:0] custom_out;
+
+  custom custom (
+    // input
+    .inst(inst),
+    .rs1(rs1_data),
+    .rs2(rs2_data),
+
+    // output
+    .out(custom_out),
+    .illegal(custom_illegal)
+  );
+
 
   // Memory
 
@@ -192,7 +335,43 @@ module datapath #(
   );
 
   assign dmem_addr = alu_out;
-  assign dmem_wdata = rs2_data;
+  assign dmem_re = dmem_load && ~kill;
+  assign dmem_we = dmem_store && ~kill && ((amo_op != AMO_SC) || sc_ok);
+
+  amo amo (
+    // input
+    .op(amo_op),
+    .mem_data(dmem_rdata),
+    .rs2(rs2_data),
+
+    // output
+    .out(dmem_wdata)
+  );
+
+  // LR/SC reservation. Any store to the reserved word breaks it.
+
+  reg resv_valid;
+  reg [XLEN-1:0] resv_addr;
+
+  assign sc_ok = resv_valid && (resv_addr[XLEN-1:2] == alu_out[XLEN-1:2]);
+
+  always @(posedge clk) begin
+    if (reset) begin
+      resv_valid <= 1'b0;
+    end else begin
+      if (bus_we && (bus_addr[XLEN-1:2] == resv_addr[XLEN-1:2])) begin
+        resv_valid <= 1'b0;
+      end
+      if (retire) begin
+        if (amo_op == AMO_LR) begin
+          resv_valid <= 1'b1;
+          resv_addr <= alu_out;
+        end else if (amo_op == AMO_SC) begin
+          resv_valid <= 1'b0;
+        end
+      end
+    end
+  end
 
   always @(*) begin
     case (dmem_type)
@@ -209,30 +388,77 @@ module datapath #(
     case (wb_sel)
       WB_MEM: reg_wdata = load_data;
       WB_CSR: reg_wdata = csr_rdata;
+      WB_SC: reg_wdata = {{(XLEN - 1){1'b0}}, ~sc_ok};
+      WB_CUSTOM: reg_wdata = custom_out;
       default: reg_wdata = alu_out;
     endcase
   end
 
-  generate
-  if (ENABLE_COUNTERS) begin
-    wire [CSR_ADDR_LEN-1:0] csr_addr = inst[31:20];
-    wire [XLEN-1:0] csr_imm = {{(XLEN - 5){1'b0}}, inst[19:15]};
-    wire [XLEN-1:0] csr_wdata = (csr_sel == CSR_SEL_IMM) ? csr_imm : rs1_data;
-
-    csr csr (
-      // input
-      .clk(clk),
-      .reset(reset),
-      .cmd(csr_cmd),
-      .addr(csr_addr),
-      .wdata(csr_wdata),
-
-      // output
-      .rdata(csr_rdata)
-    );
-  end else begin
-    assign csr_rdata = 0;
+  wire [CSR_ADDR_LEN-1:0] csr_addr = inst[31:20];
+  wire [XLEN-1:0] csr_imm = {{(XLEN - 5){1'b0}}, inst[19:15]};
+  wire [XLEN-1:0] csr_wdata = (csr_sel == CSR_SEL_IMM) ? csr_imm : rs1_data;
+
+  csr #(
+    .ENABLE_COUNTERS(ENABLE_COUNTERS),
+    .HART_ID(HART_ID),
+    .PROF_PERIOD(PROF_PERIOD)
+  ) csr (
+    // input
+    .clk(clk),
+    .reset(reset),
+    .retire(retire),
+    .fused(fused),
+    .cmd(csr_cmd),
+    .addr(csr_addr),
+    .wdata(csr_wdata),
+    .timer_irq(timer_irq),
+    .trap(trap),
+    .trap_cause(irq_pending ? CAUSE_IRQ_M_TIMER : cause),
+    .trap_pc((wfi && irq_pending) ? pc + 4 : pc),
+    .trap_val(irq_pending ? `D_XLEN'h0 : tval),
+    .mret(mret),
+
+    // output
+    .rdata(csr_rdata),
+    .mtvec(mtvec),
+    .mepc(mepc),
+    .prof_period(prof_period),
+    .irq_pending(irq_pending),
+    .wake(wake)
+  );
+
+
+  // Exceptions
+
+  wire misaligned_fetch = (pc_sel != PC_PLUS_FOUR) && (pc_target[1:0] != 2'b0);
+  // The low bits of the memory type give the access size: 01 for halfwords
+  // and 10 for words.
+  wire misaligned_data = (dmem_load || dmem_store) &&
+                         (((dmem_type[1:0] == 2'b01) && alu_out[0]) ||
+                          ((dmem_type[1:0] == 2'b10) && (alu_out[1:0] != 2'b0)));
+
+  always @(*) begin
+    exception = 1'b1;
+    cause = 0;
+    tval = 0;
+
+    if (illegal) begin
+      cause = CAUSE_ILLEGAL_INST;
+      tval = inst;
+    end else if (ecall) begin
+      cause = CAUSE_ECALL_M;
+    end else if (misaligned_fetch) begin
+      cause = CAUSE_MISALIGNED_FETCH;
+      tval = pc_target;
+    end else if (misaligned_data && dmem_store) begin
+      cause = CAUSE_MISALIGNED_STORE;
+      tval = alu_out;
+    end else if (misaligned_data) begin
+      cause = CAUSE_MISALIGNED_LOAD;
+      tval = alu_out;
+    end else begin
+      exception = 1'b0;
+    end
   end
-  endgenerate
 
 endmodule
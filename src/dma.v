@@ -0,0 +1,185 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The DMA engine copies or fills blocks of words in the data memory on behalf
+// of the core. `addr` is the offset into its registers:
+//
+//   0x00  src     source address of a copy
+//   0x04  dst     destination address
+//   0x08  len     length in bytes, rounded down to whole words
+//   0x0c  ctrl    writing bit 0 starts a copy, or a fill with bit 1 also set,
+//                 and bit 0 reads as one until the transfer completes
+//   0x10  fill    word stored by a fill
+//   0x14  bytes   bytes moved since reset, read-only
+//   0x18  cycles  cycles spent on transfers since reset, read-only
+//
+// The low two bits of the addresses are ignored. src and dst advance as the
+// transfer proceeds, and writes to the registers are dropped while it runs. A
+// transfer owns the data memory port while `busy`. It moves up to BURST words
+// at a time, reading them into a buffer and then writing them out, and waits
+// WAIT cycles before each burst like the accesses of the core. A copy takes two
+// cycles per word and a fill one. The Verilator testbenches skip idle cycles
+// without advancing the engine, so transfers should complete before wfi.
+module dma #(
+  parameter BURST = 4,
+  parameter WAIT  = 0
+)(
+  input clk,
+  input reset,
+  input [XLEN-1:0] addr,
+  input [XLEN-1:0] wdata,
+  input we,
+  input [XLEN-1:0] mem_rdata,
+
+  output reg [XLEN-1:0] rdata,
+  output busy,
+  output [XLEN-1:0] mem_addr,
+  output [XLEN-1:0] mem_wdata,
+  output mem_we
+);
+
+  `include "constants.vh"
+
+  localparam SRC_OFFSET    = `D_XLEN'h00;
+  localparam DST_OFFSET    = `D_XLEN'h04;
+  localparam LEN_OFFSET    = `D_XLEN'h08;
+  localparam CTRL_OFFSET   = `D_XLEN'h0c;
+  localparam FILL_OFFSET   = `D_XLEN'h10;
+  localparam BYTES_OFFSET  = `D_XLEN'h14;
+  localparam CYCLES_OFFSET = `D_XLEN'h18;
+
+  localparam CTRL_START = 0;
+  localparam CTRL_FILL  = 1;
+
+  localparam STATE_IDLE  = 2'd0;
+  localparam STATE_READ  = 2'd1;
+  localparam STATE_WRITE = 2'd2;
+
+  localparam IDX_LEN = (BURST > 1) ? $clog2(BURST) : 1;
+  localparam WAIT_LEN = (WAIT > 0) ? $clog2(WAIT + 1) : 1;
+
+  reg [1:0] state;
+  reg fill_mode;
+  reg [XLEN-1:0] src;
+  reg [XLEN-1:0] dst;
+  reg [XLEN-1:0] len;
+  reg [XLEN-1:0] fill;
+  reg [XLEN-1:0] bytes;
+  reg [XLEN-1:0] cycles;
+
+  // `words` counts the words left to write, `burst` the words in the current
+  // burst and `idx` the position within it.
+  reg [XLEN-3:0] words;
+  reg [IDX_LEN:0] burst;
+  reg [IDX_LEN-1:0] idx;
+  reg [WAIT_LEN-1:0] wait_cnt;
+  reg [XLEN-1:0] buffer [0:BURST-1];
+
+  wire ready = (wait_cnt == WAIT);
+  wire last = (idx == burst - 1);
+
+  // Words left after the current burst, and the size of the next one.
+  wire [XLEN-3:0] rest = words - burst;
+  wire [IDX_LEN:0] next_burst = (rest < BURST) ? rest[IDX_LEN:0] : BURST;
+
+  wire start = we && (addr == CTRL_OFFSET) && wdata[CTRL_START] &&
+               (len[XLEN-1:2] != 0);
+
+  assign busy = (state != STATE_IDLE);
+  assign mem_addr = {(state == STATE_READ) ? src[XLEN-1:2] : dst[XLEN-1:2],
+                     2'b0};
+  assign mem_wdata = fill_mode ? fill : buffer[idx];
+  assign mem_we = (state == STATE_WRITE) && ready;
+
+  always @(*) begin
+    case (addr)
+      SRC_OFFSET: rdata = src;
+      DST_OFFSET: rdata = dst;
+      LEN_OFFSET: rdata = len;
+      CTRL_OFFSET: rdata = {{(XLEN-1){1'b0}}, busy};
+      FILL_OFFSET: rdata = fill;
+      BYTES_OFFSET: rdata = bytes;
+      CYCLES_OFFSET: rdata = cycles;
+      default: rdata = 0;
+    endcase
+  end
+
+  always @(posedge clk) begin
+    if (reset) begin
+      state <= STATE_IDLE;
+      fill_mode <= 1'b0;
+      src <= 0;
+      dst <= 0;
+      len <= 0;
+      fill <= 0;
+      bytes <= 0;
+      cycles <= 0;
+      words <= 0;
+      burst <= 0;
+      idx <= 0;
+      wait_cnt <= 0;
+    end else if (state == STATE_IDLE) begin
+      if (we) begin
+        case (addr)
+          SRC_OFFSET: src <= wdata;
+          DST_OFFSET: dst <= wdata;
+          LEN_OFFSET: len <= wdata;
+          FILL_OFFSET: fill <= wdata;
+          default: ;
+        endcase
+      end
+      if (start) begin
+        state <= wdata[CTRL_FILL] ? STATE_WRITE : STATE_READ;
+        fill_mode <= wdata[CTRL_FILL];
+        words <= len[XLEN-1:2];
+        burst <= (len[XLEN-1:2] < BURST) ? len[IDX_LEN+2:2] : BURST;
+        idx <= 0;
+        wait_cnt <= 0;
+      end
+    end else begin
+      cycles <= cycles + 1;
+      if (~ready) begin
+        wait_cnt <= wait_cnt + 1;
+      end else if (state == STATE_READ) begin
+        buffer[idx] <= mem_rdata;
+        src <= src + 4;
+        idx <= last ? 0 : idx + 1;
+        if (last) begin
+          state <= STATE_WRITE;
+          wait_cnt <= 0;
+        end
+      end else begin
+        dst <= dst + 4;
+        bytes <= bytes + 4;
+        idx <= last ? 0 : idx + 1;
+        if (last) begin
+          words <= rest;
+          burst <= next_burst;
+          wait_cnt <= 0;
+          if (rest == 0) state <= STATE_IDLE;
+          else if (~fill_mode) state <= STATE_READ;
+        end
+      end
+    end
+  end
+
+endmodule
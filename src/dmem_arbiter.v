@@ -0,0 +1,79 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The data memory arbiter lets several harts share one data memory port. One
+// request is granted per cycle in round-robin order and the other requesting
+// harts are stalled until their turn comes.
+module dmem_arbiter #(
+  parameter NPORTS = 2
+)(
+  input clk,
+  input reset,
+  input [NPORTS-1:0] re,
+  input [NPORTS-1:0] we,
+  input [NPORTS*XLEN-1:0] addr,
+  input [NPORTS*XLEN-1:0] wdata,
+  input [NPORTS*XLEN-1:0] wmask,
+
+  output [NPORTS-1:0] stall,
+  output [XLEN-1:0] bus_addr,
+  output [XLEN-1:0] bus_wdata,
+  output [XLEN-1:0] bus_wmask,
+  output bus_we
+);
+
+  `include "constants.vh"
+
+  localparam IDX_LEN = (NPORTS > 1) ? $clog2(NPORTS) : 1;
+
+  wire [NPORTS-1:0] req = re | we;
+  reg [IDX_LEN-1:0] last;
+  reg [IDX_LEN-1:0] idx;
+  reg found;
+  integer i;
+
+  // Search the ports starting from the one after the last granted port.
+  always @(*) begin
+    found = 1'b0;
+    idx = 0;
+    for (i = 1; i <= NPORTS; i = i + 1) begin
+      if (!found && req[(last + i) % NPORTS]) begin
+        found = 1'b1;
+        idx = (last + i) % NPORTS;
+      end
+    end
+  end
+
+  always @(posedge clk) begin
+    if (reset) last <= NPORTS - 1;
+    else if (found) last <= idx;
+  end
+
+  wire [NPORTS-1:0] grant = found ? (1 << idx) : 0;
+
+  assign stall = req & ~grant;
+  assign bus_addr = addr[idx*XLEN +: XLEN];
+  assign bus_wdata = wdata[idx*XLEN +: XLEN];
+  assign bus_wmask = wmask[idx*XLEN +: XLEN];
+  assign bus_we = found && we[idx];
+
+endmodule
@@ -0,0 +1,101 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The fusion unit looks at the instruction at pc together with the one after
+// it and recognizes pairs that the datapath can execute in a single cycle:
+//
+//   lui/auipc rd, hi  + addi rd, rd, lo    constants and addresses
+//   lui/auipc rd, hi  + load rd, lo(rd)    loads from absolute addresses
+//   auipc rd, hi      + jalr rd, lo(rd)    calls
+//   slli rd, rs1, sh  + add rd, rd, rs2    indexing, in either operand order
+//
+// Both instructions of a pair write rd, so the result of the first one is dead
+// once the second retires. The datapath executes the second instruction as if
+// at pc + 4, with `first_out`, the result of the first, in place of rd, and
+// reads its other operand from `rs2_addr`. Pairs whose second instruction
+// would raise an exception are not fused, so traps always see the first
+// instruction retired on its own.
+module fusion (
+  input [XLEN-1:0] pc,
+  input [XLEN-1:0] inst,
+  input [XLEN-1:0] next_inst,
+  input [XLEN-1:0] rs1_data,
+
+  output fused,
+  output reg [XLEN-1:0] first_out,
+  output [REG_ADDR_LEN-1:0] rs2_addr
+);
+
+  `include "constants.vh"
+  `include "rv_constants.vh"
+
+  wire [6:0] opcode = inst[6:0];
+  wire [2:0] funct3 = inst[14:12];
+  wire [6:0] funct7 = inst[31:25];
+  wire [REG_ADDR_LEN-1:0] rd = inst[11:7];
+  wire [XLEN-1:0] imm_u = {inst[31:12], 12'b0};
+
+  wire [6:0] next_opcode = next_inst[6:0];
+  wire [2:0] next_funct3 = next_inst[14:12];
+  wire [6:0] next_funct7 = next_inst[31:25];
+  wire [REG_ADDR_LEN-1:0] next_rs1 = next_inst[19:15];
+  wire [REG_ADDR_LEN-1:0] next_rs2 = next_inst[24:20];
+  wire [XLEN-1:0] next_imm_i = {{21{next_inst[31]}}, next_inst[30:20]};
+
+  wire is_lui = (opcode == RV_LUI);
+  wire is_auipc = (opcode == RV_AUIPC);
+  wire is_slli = (opcode == RV_OP_IMM) && (funct3 == RV_FUNCT3_SLL) &&
+                 (funct7 == 0);
+
+  // The second instruction must overwrite rd and read it through rs1, or
+  // through exactly one of its operands for add.
+  wire same_rd = (rd != 0) && (next_inst[11:7] == rd);
+  wire reads_rd = (next_rs1 == rd);
+  wire is_addi = (next_opcode == RV_OP_IMM) &&
+                 (next_funct3 == RV_FUNCT3_ADD_SUB) && reads_rd;
+  wire is_load = (next_opcode == RV_LOAD) && (next_funct3 != 3'b011) &&
+                 (next_funct3 != 3'b110) && (next_funct3 != 3'b111) && reads_rd;
+  wire is_jalr = (next_opcode == RV_JALR) && (next_funct3 == 0) && reads_rd;
+  wire is_add = (next_opcode == RV_OP) && (next_funct3 == RV_FUNCT3_ADD_SUB) &&
+                (next_funct7 == 0) && (reads_rd != (next_rs2 == rd));
+
+  always @(*) begin
+    if (is_lui) first_out = imm_u;
+    else if (is_auipc) first_out = pc + imm_u;
+    else first_out = rs1_data << inst[24:20];
+  end
+
+  // Loads and jalr compute their address the same way as the datapath, which
+  // clears the low bit of the jalr sum.
+  wire [XLEN-1:0] sum = first_out + next_imm_i;
+  wire [XLEN-1:0] target = is_jalr ? sum & ~(`D_XLEN'b1) : sum;
+  wire misaligned = is_jalr ? (target[1:0] != 2'b0) :
+                    (next_funct3[1:0] == 2'b01) ? target[0] :
+                    (next_funct3[1:0] == 2'b10) ? (target[1:0] != 2'b0) : 1'b0;
+
+  wire pair = ((is_lui || is_auipc) && (is_addi || is_load)) ||
+              (is_auipc && is_jalr) || (is_slli && is_add);
+
+  assign fused = same_rd && pair && ~((is_load || is_jalr) && misaligned);
+  assign rs2_addr = reads_rd ? next_rs2 : next_rs1;
+
+endmodule
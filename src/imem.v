@@ -21,20 +21,32 @@
 
 
 // The instruction memory store instructions that the datapath will execute.
+// Each of the NPORTS read ports serves one hart and also returns the word after
+// the one addressed, for the fusion unit.
 module imem #(
-  parameter NWORDS = (1 << XLEN) / (XLEN / 8)
+  parameter NWORDS = (1 << XLEN) / (XLEN / 8),
+  parameter NPORTS = 1
 )(
-  input [XLEN-1:0] addr,
+  input [NPORTS*XLEN-1:0] addr,
 
-  output [XLEN-1:0] rdata
+  output [NPORTS*XLEN-1:0] rdata,
+  output [NPORTS*XLEN-1:0] next_rdata
 );
 
   `include "constants.vh"
 
   reg [XLEN-1:0] mem [0:NWORDS-1];
-  wire [XLEN-1:0] mem_idx = addr >> 2;
 
-  assign rdata = mem[mem_idx];
+  genvar i;
+  generate
+  for (i = 0; i < NPORTS; i = i + 1) begin : port
+    wire [XLEN-1:0] mem_idx = addr[i*XLEN +: XLEN] >> 2;
+    assign rdata[i*XLEN +: XLEN] = mem[mem_idx];
+    wire [XLEN-1:0] next_idx = mem_idx + 1;
+    assign next_rdata[i*XLEN +: XLEN] =
+      (next_idx < NWORDS) ? mem[next_idx] : 0;
+  end
+  endgenerate
 
   initial begin
     $readmemh("imem.hex", mem);
@@ -49,7 +49,7 @@ module pc_mux (
       end
       PC_JALR: begin
         base = rs1_data;
-        offset = imm_i & ~(`D_XLEN'b1);
+        offset = imm_i;
       end
       PC_BRANCH: begin
         if (branch) begin
@@ -60,6 +60,8 @@ module pc_mux (
     endcase
   end
 
-  assign pc_out = base + offset;
+  // jalr clears the low bit of the sum, not of the offset alone
+  wire [XLEN-1:0] sum = base + offset;
+  assign pc_out = (sel == PC_JALR) ? sum & ~(`D_XLEN'b1) : sum;
 
 endmodule
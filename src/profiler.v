@@ -0,0 +1,97 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The profiler samples `pc` once every `period` cycles into a circular buffer
+// of DEPTH entries, which must be a power of two. Sampling stops while `period`
+// is zero or `en` is low. The buffer is read through `addr`, an offset into the
+// device:
+//
+//   0x0000  number of samples taken so far
+//   0x0004  DEPTH
+//   0x1000  sample buffer, indexed by the sample number modulo DEPTH
+//
+// Verilator testbenches can drain the buffer directly through the exported
+// DPI functions instead.
+module profiler #(
+  parameter DEPTH = 256
+)(
+  input clk,
+  input reset,
+  input en,
+  input [XLEN-1:0] period,
+  input [XLEN-1:0] pc,
+  input [XLEN-1:0] addr,
+
+  output reg [XLEN-1:0] rdata
+);
+
+  `include "constants.vh"
+
+  localparam COUNT_OFFSET  = `D_XLEN'h0;
+  localparam DEPTH_OFFSET  = `D_XLEN'h4;
+  localparam BUFFER_OFFSET = `D_XLEN'h1000;
+
+  reg [XLEN-1:0] samples [0:DEPTH-1];
+  reg [XLEN-1:0] count;
+  reg [XLEN-1:0] elapsed;
+
+  always @(posedge clk) begin
+    if (reset) begin
+      count <= 0;
+      elapsed <= 0;
+    end else if (en && period != 0) begin
+      if (elapsed + 1 >= period) begin
+        samples[count % DEPTH] <= pc;
+        count <= count + 1;
+        elapsed <= 0;
+      end else begin
+        elapsed <= elapsed + 1;
+      end
+    end
+  end
+
+  always @(*) begin
+    if (addr >= BUFFER_OFFSET) rdata = samples[((addr - BUFFER_OFFSET) >> 2) % DEPTH];
+    else if (addr == COUNT_OFFSET) rdata = count;
+    else if (addr == DEPTH_OFFSET) rdata = DEPTH;
+    else rdata = 0;
+  end
+
+`ifdef VERILATOR
+  export "DPI-C" function profiler_count;
+  export "DPI-C" function profiler_depth;
+  export "DPI-C" function profiler_sample;
+
+  function int profiler_count();
+    profiler_count = count;
+  endfunction
+
+  function int profiler_depth();
+    profiler_depth = DEPTH;
+  endfunction
+
+  function int profiler_sample(input int n);
+    profiler_sample = samples[n % DEPTH];
+  endfunction
+`endif
+
+endmodule
@@ -0,0 +1,123 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The puzzle unit accelerates the sliding puzzle solver on boards packed at
+// four bits per tile, the same as board_t. A board of up to 16 tiles is held
+// in two registers, tiles 0-7 in the low word and tiles 8-15 in the high
+// word, and the blank is tile 0.
+//
+//   pz.dist  rd, lo, hi    funct3 0  Manhattan distance of a 3x3 board.
+//                                    Larger boards use the pattern database
+//                                    instead.
+//   pz.get   rd, half, n   funct3 1  Tile n % 8 of one half of a board.
+//   pz.move  rd, half, m   funct3 2  Moves a tile within a board. m holds the
+//                                    tile in bits 11:8, its position in bits
+//                                    7:4 and the blank in bits 3:0. The half
+//                                    is the low word if funct7 is 0 and the
+//                                    high word if it is 1. The tile replaces
+//                                    the blank and its old position is
+//                                    cleared, where they fall in the half.
+//                                    If the position falls in the half, the
+//                                    tile is read from it and bits 11:8 are
+//                                    ignored, so a move within one half takes
+//                                    a single instruction.
+module puzzle_unit (
+  input [2:0] funct3,
+  input [6:0] funct7,
+  input [XLEN-1:0] rs1,
+  input [XLEN-1:0] rs2,
+
+  output reg [XLEN-1:0] out,
+  output reg illegal
+);
+
+  `include "constants.vh"
+
+  localparam FUNCT3_DIST = 3'd0,
+             FUNCT3_GET  = 3'd1,
+             FUNCT3_MOVE = 3'd2;
+
+  localparam NTILES = 16;
+
+  wire [4*NTILES-1:0] board = {rs2, rs1};
+
+  function [1:0] div3(input [3:0] n);
+    div3 = (n >= 6) ? 2'd2 : (n >= 3) ? 2'd1 : 2'd0;
+  endfunction
+
+  function [3:0] distance(input [1:0] a_row, input [1:0] a_col,
+                          input [1:0] b_row, input [1:0] b_col);
+    distance = ((a_row > b_row) ? a_row - b_row : b_row - a_row) +
+               ((a_col > b_col) ? a_col - b_col : b_col - a_col);
+  endfunction
+
+  // The distance of every tile from its home is looked up in parallel and
+  // summed by an adder tree.
+  reg [7:0] dist3;
+  integer i;
+
+  always @(*) begin
+    dist3 = 0;
+    for (i = 0; i < 9; i = i + 1) begin : tiles
+      reg [3:0] tile;
+      reg [3:0] home;
+      reg [3:0] pos;
+      tile = board[4*i +: 4];
+      home = tile - 1;
+      pos = i;
+      if (tile != 0) begin
+        dist3 = dist3 + distance(div3(home), home - 3 * div3(home),
+                                 div3(pos), pos - 3 * div3(pos));
+      end
+    end
+  end
+
+  wire [3:0] move_from = rs2[7:4];
+  wire [3:0] move_to = rs2[3:0];
+  wire move_half = funct7[0];
+  wire [3:0] move_tile = (move_from[3] == move_half) ?
+                         rs1[4*move_from[2:0] +: 4] : rs2[11:8];
+
+  always @(*) begin
+    out = 0;
+    illegal = 1'b0;
+
+    case (funct3)
+      FUNCT3_DIST: begin
+        out = {24'b0, dist3};
+        if (funct7 != 0) illegal = 1'b1;
+      end
+      FUNCT3_GET: begin
+        out = {28'b0, rs1[4*rs2[2:0] +: 4]};
+        if (funct7 != 0) illegal = 1'b1;
+      end
+      FUNCT3_MOVE: begin
+        out = rs1;
+        if (move_from[3] == move_half) out[4*move_from[2:0] +: 4] = 4'b0;
+        if (move_to[3] == move_half) out[4*move_to[2:0] +: 4] = move_tile;
+        if (funct7[6:1] != 0) illegal = 1'b1;
+      end
+      default: illegal = 1'b1;
+    endcase
+  end
+
+endmodule
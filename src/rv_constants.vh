@@ -43,7 +43,8 @@ localparam RV_LOAD     = 7'b0000011,
            RV_AUIPC    = 7'b0010111,
            RV_LUI      = 7'b0110111,
            RV_CUSTOM_2 = 7'b1011011,
-           RV_CUSTOM_3 = 7'b1111011;
+           RV_CUSTOM_3 = 7'b1111011,
+           RV_OP_P     = 7'b1110111;
 
 // funct3 arithmetic
 localparam RV_FUNCT3_ADD_SUB = 0,
@@ -80,7 +81,33 @@ localparam RV_FUNCT3_PRIV = 0,
 localparam RV_FUNCT12_ECALL = 12'b000000000000,
            RV_FUNCT12_EBREAK = 12'b000000000001,
            RV_FUNCT12_ERET = 12'b000100000000,
-           RV_FUNCT12_WFI = 12'b000100000010;
+           RV_FUNCT12_WFI = 12'b000100000101,
+           RV_FUNCT12_MRET = 12'b001100000010;
+
+// P encodings (packed SIMD subset, funct3 0)
+localparam RV_FUNCT7_ADD8 = 7'b0100100,
+           RV_FUNCT7_ADD16 = 7'b0100000,
+           RV_FUNCT7_SUB8 = 7'b0100101,
+           RV_FUNCT7_SUB16 = 7'b0100001,
+           RV_FUNCT7_CMPEQ8 = 7'b0100111,
+           RV_FUNCT7_CMPEQ16 = 7'b0100110,
+           RV_FUNCT7_SCMPLT8 = 7'b0000111,
+           RV_FUNCT7_SCMPLT16 = 7'b0000110,
+           RV_FUNCT7_SCMPLE8 = 7'b0001111,
+           RV_FUNCT7_SCMPLE16 = 7'b0001110,
+           RV_FUNCT7_UCMPLT8 = 7'b0010111,
+           RV_FUNCT7_UCMPLT16 = 7'b0010110,
+           RV_FUNCT7_UCMPLE8 = 7'b0011111,
+           RV_FUNCT7_UCMPLE16 = 7'b0011110,
+           RV_FUNCT7_SMIN8 = 7'b1000100,
+           RV_FUNCT7_SMIN16 = 7'b1000000,
+           RV_FUNCT7_SMAX8 = 7'b1000101,
+           RV_FUNCT7_SMAX16 = 7'b1000001,
+           RV_FUNCT7_UMIN8 = 7'b1001100,
+           RV_FUNCT7_UMIN16 = 7'b1001000,
+           RV_FUNCT7_UMAX8 = 7'b1001101,
+           RV_FUNCT7_UMAX16 = 7'b1001001,
+           RV_FUNCT7_PBSAD = 7'b1111110;
 
 // RVM encodings
 localparam RV_FUNCT7_MUL_DIV = 7'd1,
@@ -92,3 +119,18 @@ localparam RV_FUNCT7_MUL_DIV = 7'd1,
            RV_FUNCT3_DIVU = 3'd5,
            RV_FUNCT3_REM = 3'd6,
            RV_FUNCT3_REMU = 3'd7;
+
+
+// RVA encodings
+localparam RV_FUNCT3_AMO_W = 3'b010,
+           RV_FUNCT5_LR = 5'b00010,
+           RV_FUNCT5_SC = 5'b00011,
+           RV_FUNCT5_AMOSWAP = 5'b00001,
+           RV_FUNCT5_AMOADD = 5'b00000,
+           RV_FUNCT5_AMOXOR = 5'b00100,
+           RV_FUNCT5_AMOAND = 5'b01100,
+           RV_FUNCT5_AMOOR = 5'b01000,
+           RV_FUNCT5_AMOMIN = 5'b10000,
+           RV_FUNCT5_AMOMAX = 5'b10100,
+           RV_FUNCT5_AMOMINU = 5'b11000,
+           RV_FUNCT5_AMOMAXU = 5'b11100;
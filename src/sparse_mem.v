@@ -0,0 +1,91 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The sparse memory serves the instruction ports and the data port from a
+// single memory kept by the Verilator testbench, which allocates it in pages
+// as the program touches it. Unlike imem and dmem it covers the whole address
+// space, and the program is loaded from its ELF rather than from hex files.
+module sparse_mem #(
+  parameter NPORTS = 1
+)(
+  input clk,
+  input reset,
+  input [NPORTS*XLEN-1:0] imem_addr,
+  input [XLEN-1:0] dmem_addr,
+  input [XLEN-1:0] dmem_wdata,
+  input [XLEN-1:0] dmem_wmask,
+  input dmem_we,
+
+  output [NPORTS*XLEN-1:0] imem_rdata,
+  output [NPORTS*XLEN-1:0] imem_next_rdata,
+  output [XLEN-1:0] dmem_rdata
+);
+
+  `include "constants.vh"
+
+  localparam SHAMT_WIDTH = 5;
+
+`ifdef VERILATOR
+  // Reads also take a version number that changes after every store and
+  // while in reset, when the testbench may load a new program. This makes
+  // Verilator evaluate them again whenever the memory may have changed.
+  import "DPI-C" pure function int sparse_mem_read(input int addr,
+                                                   input int version);
+  import "DPI-C" function void sparse_mem_write(input int addr, input int data,
+                                                input int mask);
+
+  wire [SHAMT_WIDTH-1:0] shamt = {dmem_addr[1:0], 3'b0};
+  reg [XLEN-1:0] version = 0;
+
+  genvar i;
+  generate
+  for (i = 0; i < NPORTS; i = i + 1) begin : port
+    assign imem_rdata[i*XLEN +: XLEN] =
+      sparse_mem_read(imem_addr[i*XLEN +: XLEN], version);
+    assign imem_next_rdata[i*XLEN +: XLEN] =
+      sparse_mem_read(imem_addr[i*XLEN +: XLEN] + 4, version);
+  end
+  endgenerate
+
+  assign dmem_rdata = sparse_mem_read(dmem_addr, version);
+
+  always @(posedge clk) begin
+    if (dmem_we) begin
+      sparse_mem_write(dmem_addr, (dmem_wdata & dmem_wmask) << shamt,
+                       dmem_wmask << shamt);
+    end
+    if (reset || dmem_we) begin
+      version <= version + 1;
+    end
+  end
+`else
+  assign imem_rdata = 0;
+  assign imem_next_rdata = 0;
+  assign dmem_rdata = 0;
+
+  initial begin
+    $display("sparse_mem: only supported on Verilator");
+    $finish;
+  end
+`endif
+
+endmodule
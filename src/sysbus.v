@@ -0,0 +1,148 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The system bus sits between the data side of the datapath and the data
+// memory. It decodes accesses to the memory-mapped devices and forwards the
+// rest to the data memory. The profiler samples the pc of a single hart.
+//
+// Writes to the console address print a character, and reads from it and the
+// word after it reach the console receiver, which buffers the input bytes
+// offered on `console_rx_*`. `re` marks a read that completes in this cycle.
+module sysbus #(
+  parameter NHARTS = 1
+)(
+  input clk,
+  input reset,
+  input [XLEN-1:0] addr,
+  input [XLEN-1:0] wdata,
+  input we,
+  input re,
+  input [XLEN-1:0] dmem_rdata,
+  input [XLEN-1:0] prof_pc,
+  input [XLEN-1:0] prof_period,
+  input prof_en,
+  input console_rx_valid,
+  input [7:0] console_rx_data,
+  input console_rx_eof,
+
+  output [XLEN-1:0] rdata,
+  output [NHARTS-1:0] timer_irq,
+  output reg [XLEN-1:0] dmem_wdata,
+  output reg dmem_we,
+  output reg [XLEN-1:0] console_wdata,
+  output reg console_we,
+  output console_rx_ready,
+  output reg test_passed = 1'b0
+);
+
+  `include "constants.vh"
+
+  localparam CONSOLE_ADDR   = `D_XLEN'h1000_0000;
+  localparam CONSOLE_SIZE   = `D_XLEN'h0000_0008;
+  localparam TEST_STAT_ADDR = `D_XLEN'h2000_0000;
+  localparam TIMER_ADDR     = `D_XLEN'h0200_0000;
+  localparam TIMER_SIZE     = `D_XLEN'h0001_0000;
+  localparam PROF_ADDR      = `D_XLEN'h0300_0000;
+  localparam PROF_SIZE      = `D_XLEN'h0001_0000;
+
+  wire is_console = we && (addr == CONSOLE_ADDR);
+  wire is_test_res = we && (addr == TEST_STAT_ADDR) && (wdata == 123456789);
+  wire is_timer = ((addr & ~(TIMER_SIZE - 1)) == TIMER_ADDR);
+  wire is_prof = ((addr & ~(PROF_SIZE - 1)) == PROF_ADDR);
+  wire is_console_rx = ~we && ((addr & ~(CONSOLE_SIZE - 1)) == CONSOLE_ADDR);
+
+  wire [XLEN-1:0] timer_rdata;
+  wire [XLEN-1:0] prof_rdata;
+  wire [XLEN-1:0] console_rdata;
+
+  timer #(
+    .NHARTS(NHARTS)
+  ) timer (
+    // input
+    .clk(clk),
+    .reset(reset),
+    .addr(addr - TIMER_ADDR),
+    .wdata(wdata),
+    .we(we && is_timer),
+
+    // output
+    .rdata(timer_rdata),
+    .irq(timer_irq)
+  );
+
+  profiler profiler (
+    // input
+    .clk(clk),
+    .reset(reset),
+    .en(prof_en),
+    .period(prof_period),
+    .pc(prof_pc),
+    .addr(addr - PROF_ADDR),
+
+    // output
+    .rdata(prof_rdata)
+  );
+
+  console_rx console_rx (
+    // input
+    .clk(clk),
+    .reset(reset),
+    .addr(addr - CONSOLE_ADDR),
+    .re(re && is_console_rx),
+    .in_valid(console_rx_valid),
+    .in_data(console_rx_data),
+    .in_eof(console_rx_eof),
+
+    // output
+    .rdata(console_rdata),
+    .in_ready(console_rx_ready)
+  );
+
+  assign rdata = is_timer ? timer_rdata :
+                 is_prof ? prof_rdata :
+                 is_console_rx ? console_rdata : dmem_rdata;
+
+  always @(*) begin
+    dmem_we = 1'b0;
+    dmem_wdata = `D_XLEN'b0;
+    console_we = 1'b0;
+    console_wdata = `D_XLEN'b0;
+    if (reset) begin
+      test_passed = 1'b0;
+    end
+
+    if (is_console) begin
+      console_we = 1'b1;
+      console_wdata = wdata;
+    end else if (is_test_res) begin
+      test_passed = 1'b1;
+    end else if (is_timer) begin
+      // handled by the timer
+    end else if (is_prof) begin
+      // the profiler is read-only
+    end else begin
+      dmem_we = we;
+      dmem_wdata = wdata;
+    end
+  end
+
+endmodule
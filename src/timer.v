@@ -0,0 +1,120 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The machine timer implements mtime and the per-hart mtimecmp registers with
+// the register layout of the RISC-V CLINT. `addr` is the offset into the
+// device. A hart's timer interrupt is pending while mtime >= its mtimecmp.
+//
+// Verilator testbenches fast-forward mtime over idle cycles through the
+// exported DPI functions.
+module timer #(
+  parameter NHARTS = 1
+)(
+  input clk,
+  input reset,
+  input [XLEN-1:0] addr,
+  input [XLEN-1:0] wdata,
+  input we,
+
+  output reg [XLEN-1:0] rdata,
+  output [NHARTS-1:0] irq
+);
+
+  `include "constants.vh"
+
+  localparam MTIMECMP_OFFSET = `D_XLEN'h4000;
+  localparam MTIME_OFFSET    = `D_XLEN'hBFF8;
+
+  reg [63:0] mtime;
+  reg [63:0] mtimecmp [0:NHARTS-1];
+
+  wire is_mtime = ((addr >> 3) == (MTIME_OFFSET >> 3));
+  wire is_mtimecmp = (addr >= MTIMECMP_OFFSET) && (addr < MTIMECMP_OFFSET + 8 * NHARTS);
+  wire [XLEN-1:0] hart = (addr - MTIMECMP_OFFSET) >> 3;
+
+  always @(*) begin
+    rdata = 0;
+    if (is_mtime) begin
+      rdata = addr[2] ? mtime[63:32] : mtime[31:0];
+    end else if (is_mtimecmp) begin
+      rdata = addr[2] ? mtimecmp[hart][63:32] : mtimecmp[hart][31:0];
+    end
+  end
+
+  genvar h;
+  generate
+  for (h = 0; h < NHARTS; h = h + 1) begin : hart_irq
+    assign irq[h] = (mtime >= mtimecmp[h]);
+  end
+  endgenerate
+
+  integer i;
+
+  always @(posedge clk) begin
+    if (reset) begin
+      mtime <= 0;
+      for (i = 0; i < NHARTS; i = i + 1) begin
+        mtimecmp[i] <= ~64'h0;
+      end
+    end else begin
+      mtime <= mtime + 1;
+      if (we && is_mtime) begin
+        if (addr[2]) mtime[63:32] <= wdata;
+        else mtime[31:0] <= wdata;
+      end
+      if (we && is_mtimecmp) begin
+        if (addr[2]) mtimecmp[hart][63:32] <= wdata;
+        else mtimecmp[hart][31:0] <= wdata;
+      end
+    end
+  end
+
+`ifdef VERILATOR
+  import "DPI-C" context function void idle_register_timer();
+  export "DPI-C" function timer_next_event;
+  export "DPI-C" function timer_skip;
+
+  initial idle_register_timer();
+
+  // Returns the number of cycles until mtime reaches the nearest mtimecmp
+  // ahead of it, or -1 if there is none within 2^63 cycles.
+  function longint timer_next_event();
+    integer n;
+    reg [63:0] delta;
+    begin
+      timer_next_event = -1;
+      for (n = 0; n < NHARTS; n = n + 1) begin
+        delta = mtimecmp[n] - mtime;
+        if ((mtimecmp[n] > mtime) && ~delta[63] &&
+            ((timer_next_event < 0) || (delta < timer_next_event))) begin
+          timer_next_event = delta;
+        end
+      end
+    end
+  endfunction
+
+  function void timer_skip(input longint cycles);
+    mtime = mtime + cycles;
+  endfunction
+`endif
+
+endmodule
@@ -0,0 +1,78 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// The unified memory serves the instruction ports and the data port from a
+// single array loaded once from imem.hex, in place of imem and dmem with their
+// two copies of the image. Fetches see the stores of the data port right away,
+// so code that writes code runs as written.
+module unified_mem #(
+  parameter NWORDS = (1 << XLEN) / (XLEN / 8),
+  parameter NPORTS = 1
+)(
+  input clk,
+  input [NPORTS*XLEN-1:0] imem_addr,
+  input [XLEN-1:0] dmem_addr,
+  input [XLEN-1:0] dmem_wdata,
+  input [XLEN-1:0] dmem_wmask,
+  input dmem_we,
+
+  output [NPORTS*XLEN-1:0] imem_rdata,
+  output [NPORTS*XLEN-1:0] imem_next_rdata,
+  output [XLEN-1:0] dmem_rdata
+);
+
+  `include "constants.vh"
+
+  localparam SHAMT_WIDTH = 5;
+
+  reg [XLEN-1:0] mem [0:NWORDS-1];
+
+  genvar i;
+  generate
+  for (i = 0; i < NPORTS; i = i + 1) begin : port
+    wire [XLEN-1:0] mem_idx = imem_addr[i*XLEN +: XLEN] >> 2;
+    assign imem_rdata[i*XLEN +: XLEN] = mem[mem_idx];
+    wire [XLEN-1:0] next_idx = mem_idx + 1;
+    assign imem_next_rdata[i*XLEN +: XLEN] =
+      (next_idx < NWORDS) ? mem[next_idx] : 0;
+  end
+  endgenerate
+
+  wire [XLEN-1:0] data_idx = dmem_addr >> 2;
+  wire [SHAMT_WIDTH-1:0] shamt = {dmem_addr[1:0], 3'b0};
+  wire [XLEN-1:0] wdata_shifted = (dmem_wdata & dmem_wmask) << shamt;
+  wire [XLEN-1:0] rdata_masked = mem[data_idx] & ~(dmem_wmask << shamt);
+  wire [XLEN-1:0] to_store = wdata_shifted | rdata_masked;
+
+  assign dmem_rdata = mem[data_idx];
+
+  always @(posedge clk) begin
+    if (dmem_we) begin
+      mem[data_idx] <= to_store;
+    end
+  end
+
+  initial begin
+    $readmemh("imem.hex", mem);
+  end
+
+endmodule
@@ -0,0 +1,61 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file ports Dhrystone 2.1 to bbq. The benchmark itself is not kept in
+// the tree; the Makefile fetches it from Netlib and builds it with TIME
+// defined and time renamed to bbq_dhry_time, so that the calls before and
+// after the measured loop read the cycle counter instead. The number of runs
+// is read from the console like on any other system.
+//
+// The cycles the loop took are printed when the program exits, since
+// Dhrystone itself reports its timing in seconds. DMIPS per MHz follow from
+// them and the number of runs.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+long bbq_dhry_time(long *t);
+
+static unsigned int begin_cycles;
+static unsigned int end_cycles;
+static int calls;
+
+static unsigned int read_cycles(void) {
+  unsigned int cycles;
+  __asm__ volatile("rdcycle %0" : "=r"(cycles));
+  return cycles;
+}
+
+static void report(void) {
+  printf("Dhrystone cycles .....%9u\n", end_cycles - begin_cycles);
+}
+
+long bbq_dhry_time(long *t) {
+  const unsigned int now = read_cycles();
+  if (calls++ == 0) {
+    begin_cycles = now;
+    atexit(report);
+  } else {
+    end_cycles = now;
+  }
+  if (t) *t = now;
+  return now;
+}
@@ -0,0 +1,80 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file defines the registers of the DMA engine of the core and helpers
+// that drive it.
+//
+// The engine copies or fills whole words of the data memory. It cannot reach
+// the devices or the scratchpad, which all lie above the data memory, and
+// bbq_dma_reaches() checks that a buffer is within its range. While a
+// transfer runs, the core stalls on its own accesses to the data memory, so
+// the helpers start a transfer and poll the engine until it completes. See
+// src/dma.v for the register layout.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BBQ_DMA_ADDR 0x05000000
+
+#define BBQ_DMA_SRC 0x00
+#define BBQ_DMA_DST 0x04
+#define BBQ_DMA_LEN 0x08
+#define BBQ_DMA_CTRL 0x0c
+#define BBQ_DMA_FILL 0x10
+#define BBQ_DMA_BYTES 0x14
+#define BBQ_DMA_CYCLES 0x18
+
+#define BBQ_DMA_START 0x1
+#define BBQ_DMA_FILL_MODE 0x2
+
+#define BBQ_DMA_REG(offset) \
+  (*(volatile uint32_t*)(uintptr_t)(BBQ_DMA_ADDR + (offset)))
+
+// The data memory ends below the first device, the timer at 0x02000000.
+static inline int bbq_dma_reaches(const void* p, size_t len) {
+  uintptr_t addr = (uintptr_t)p;
+  return addr + len <= 0x02000000 && addr + len >= addr;
+}
+
+static inline void bbq_dma_wait(void) {
+  while (BBQ_DMA_REG(BBQ_DMA_CTRL) & BBQ_DMA_START) {
+  }
+}
+
+// Copies the whole words in the first `len` bytes from `src` to `dst`.
+static inline void bbq_dma_copy(void* dst, const void* src, size_t len) {
+  BBQ_DMA_REG(BBQ_DMA_SRC) = (uintptr_t)src;
+  BBQ_DMA_REG(BBQ_DMA_DST) = (uintptr_t)dst;
+  BBQ_DMA_REG(BBQ_DMA_LEN) = len;
+  BBQ_DMA_REG(BBQ_DMA_CTRL) = BBQ_DMA_START;
+  bbq_dma_wait();
+}
+
+// Stores `word` to the whole words in the first `len` bytes of `dst`.
+static inline void bbq_dma_fill(void* dst, uint32_t word, size_t len) {
+  BBQ_DMA_REG(BBQ_DMA_DST) = (uintptr_t)dst;
+  BBQ_DMA_REG(BBQ_DMA_LEN) = len;
+  BBQ_DMA_REG(BBQ_DMA_FILL) = word;
+  BBQ_DMA_REG(BBQ_DMA_CTRL) = BBQ_DMA_START | BBQ_DMA_FILL_MODE;
+  bbq_dma_wait();
+}
@@ -33,4 +33,8 @@ void multest(void);
 // stats.c
 void stats(void);
 
+// traps.c
+uint32_t trap_handler(uint32_t cause, uint32_t epc, uint32_t tval);
+void traps(void);
+
 #endif
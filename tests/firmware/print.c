@@ -6,6 +6,7 @@
 // means.
 
 #include "firmware.h"
+#include "../runtime.h"
 
 #define OUTPORT 0x10000000
 
@@ -25,8 +26,8 @@ void print_dec(unsigned int val)
 	char buffer[10];
 	char *p = buffer;
 	while (val || p == buffer) {
-		*(p++) = val % 10;
-		val = val / 10;
+		*(p++) = modu_const(val, 10);
+		val = divu_const(val, 10);
 	}
 	while (p != buffer) {
 		*((volatile uint32_t*)OUTPORT) = '0' + *(--p);
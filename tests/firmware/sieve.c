@@ -8,10 +8,12 @@
 // A simple Sieve of Eratosthenes
 
 #include "firmware.h"
+#include "../tcm.h"
 
 #define BITMAP_SIZE 64
 
-static uint32_t bitmap[BITMAP_SIZE/32];
+// kept in the scratchpad so that the test exercises it
+static uint32_t bitmap[BITMAP_SIZE/32] BBQ_TCM;
 static uint32_t hash;
 
 static uint32_t mkhash(uint32_t a, uint32_t b)
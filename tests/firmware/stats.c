@@ -6,6 +6,10 @@
 // means.
 
 #include "firmware.h"
+#include "../runtime.h"
+#ifdef BBQ_DMA
+#include "../dma.h"
+#endif
 
 static void stats_print_dec(unsigned int val, int digits, bool zero_pad)
 {
@@ -13,10 +17,10 @@ static void stats_print_dec(unsigned int val, int digits, bool zero_pad)
 	char *p = buffer;
 	while (val || digits > 0) {
 		if (val)
-			*(p++) = '0' + val % 10;
+			*(p++) = '0' + modu_const(val, 10);
 		else
 			*(p++) = zero_pad ? '0' : ' ';
-		val = val / 10;
+		val = divu_const(val, 10);
 		digits--;
 	}
 	while (p != buffer) {
@@ -27,16 +31,25 @@ static void stats_print_dec(unsigned int val, int digits, bool zero_pad)
 
 void stats(void)
 {
-	unsigned int num_cycles, num_instr;
+	unsigned int num_cycles, num_instr, num_fused;
 	__asm__("rdcycle %0; rdinstret %1;" : "=r"(num_cycles), "=r"(num_instr));
+	__asm__("csrr %0, 0xfc0" : "=r"(num_fused));
 	print_str("Cycle counter ........");
 	stats_print_dec(num_cycles, 8, false);
 	print_str("\nInstruction counter ..");
 	stats_print_dec(num_instr, 8, false);
+	print_str("\nFused pairs ..........");
+	stats_print_dec(num_fused, 8, false);
+#ifdef BBQ_DMA
+	print_str("\nDMA bytes ............");
+	stats_print_dec(BBQ_DMA_REG(BBQ_DMA_BYTES), 8, false);
+	print_str("\nDMA cycles ...........");
+	stats_print_dec(BBQ_DMA_REG(BBQ_DMA_CYCLES), 8, false);
+#endif
 	print_str("\nCPI: ");
 	stats_print_dec((num_cycles / num_instr), 0, false);
 	print_str(".");
-	stats_print_dec(((100 * num_cycles) / num_instr) % 100, 2, true);
+	stats_print_dec(modu_const((100 * num_cycles) / num_instr, 100), 2, true);
 	print_str("\n");
 }
 
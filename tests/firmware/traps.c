@@ -0,0 +1,169 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// Machine-mode traps: ecall, illegal instructions, misaligned fetches and
+// accesses, and the timer interrupt in both direct and vectored mode
+
+#include "firmware.h"
+
+#define MTIMECMP 0x02004000
+#define MTIME    0x0200bff8
+
+#define CAUSE_MISALIGNED_FETCH 0
+#define CAUSE_ILLEGAL_INST     2
+#define CAUSE_MISALIGNED_LOAD  4
+#define CAUSE_MISALIGNED_STORE 6
+#define CAUSE_ECALL_M          11
+#define CAUSE_IRQ_M_TIMER      0x80000007
+
+static volatile uint32_t last_cause;
+static volatile uint32_t last_tval;
+static volatile int timer_ticks;
+
+// set by the timer slot of trap_vector in start.S
+volatile uint32_t vectored_irq;
+
+uint32_t trap_handler(uint32_t cause, uint32_t epc, uint32_t tval)
+{
+	last_cause = cause;
+	last_tval = tval;
+
+	if (cause == CAUSE_IRQ_M_TIMER) {
+		// push mtimecmp out of reach to acknowledge the interrupt
+		*((volatile uint32_t*)(MTIMECMP + 4)) = 0xffffffff;
+		timer_ticks++;
+		return epc;
+	}
+
+	// skip the faulting instruction
+	return epc + 4;
+}
+
+static void check(const char *name, uint32_t cause, uint32_t tval)
+{
+	if (last_cause == cause && last_tval == tval) {
+		last_cause = 0;
+		last_tval = 0;
+		return;
+	}
+
+	print_str("ERROR in ");
+	print_str(name);
+	print_str(": cause=");
+	print_hex(last_cause, 8);
+	print_str(" tval=");
+	print_hex(last_tval, 8);
+	print_str("\n");
+	__asm__ volatile ("ebreak");
+}
+
+void traps(void)
+{
+	extern char trap_entry[];
+	extern char trap_vector[];
+	volatile uint32_t word = 0;
+	uint32_t addr = (uint32_t)&word + 2;
+	uint32_t val = 0;
+
+	print_str("traps: ");
+	__asm__ volatile ("csrw mtvec, %0" : : "r"(trap_entry));
+
+	__asm__ volatile ("ecall");
+	check("ecall", CAUSE_ECALL_M, 0);
+
+	__asm__ volatile (".word 0");
+	check("illegal", CAUSE_ILLEGAL_INST, 0);
+
+	// ecall with rd = x1 is not an ecall
+	__asm__ volatile (".word 0x000000f3");
+	check("ecall rd", CAUSE_ILLEGAL_INST, 0x000000f3);
+
+	// jalr clears bit 0 of rs1 + imm, so an odd base plus an odd offset
+	// lands on the aligned label without trapping
+	__asm__ volatile (
+		"la %0, 1f\n"
+		"addi %0, %0, -1\n"
+		"jalr zero, 1(%0)\n"
+		"1:\n"
+		: "=&r"(val));
+	check("jalr low bit", 0, 0);
+
+	// a jump to a halfword boundary traps at the jump, and the handler
+	// skips it
+	__asm__ volatile (
+		"la %0, 1f\n"
+		"addi %0, %0, 2\n"
+		"jalr zero, 0(%0)\n"
+		"1:\n"
+		: "=&r"(val));
+	check("misaligned fetch", CAUSE_MISALIGNED_FETCH, val);
+
+	__asm__ volatile ("lw %0, 0(%1)" : "=r"(val) : "r"(addr));
+	check("misaligned load", CAUSE_MISALIGNED_LOAD, addr);
+
+	__asm__ volatile ("sw %0, 0(%1)" : : "r"(val), "r"(addr) : "memory");
+	check("misaligned store", CAUSE_MISALIGNED_STORE, addr);
+
+	*((volatile uint32_t*)MTIMECMP) = *((volatile uint32_t*)MTIME) + 100;
+	*((volatile uint32_t*)(MTIMECMP + 4)) = 0;
+	__asm__ volatile ("csrs mie, %0" : : "r"(1 << 7));
+	__asm__ volatile ("csrs mstatus, %0" : : "r"(1 << 3));
+	for (int i = 0; i < 1000 && timer_ticks == 0; i++)
+		;
+	__asm__ volatile ("csrc mstatus, %0" : : "r"(1 << 3));
+	__asm__ volatile ("csrc mie, %0" : : "r"(1 << 7));
+	check("timer", CAUSE_IRQ_M_TIMER, 0);
+
+	// wfi wakes up on an interrupt enabled in mie even if mstatus masks it
+	*((volatile uint32_t*)MTIMECMP) = *((volatile uint32_t*)MTIME) + 100;
+	*((volatile uint32_t*)(MTIMECMP + 4)) = 0;
+	__asm__ volatile ("csrs mie, %0" : : "r"(1 << 7));
+	__asm__ volatile ("wfi");
+	__asm__ volatile ("csrr %0, mip" : "=r"(val));
+	last_cause = val & (1 << 7) ? CAUSE_IRQ_M_TIMER : 0;
+	check("wfi", CAUSE_IRQ_M_TIMER, 0);
+
+	// and returns to the following instruction once the interrupt is taken
+	*((volatile uint32_t*)MTIMECMP) = *((volatile uint32_t*)MTIME) + 100;
+	__asm__ volatile ("csrs mstatus, %0" : : "r"(1 << 3));
+	__asm__ volatile ("wfi");
+	__asm__ volatile ("csrc mstatus, %0" : : "r"(1 << 3));
+	__asm__ volatile ("csrc mie, %0" : : "r"(1 << 7));
+	check("wfi interrupt", CAUSE_IRQ_M_TIMER, 0);
+
+	// in vectored mode exceptions still enter at the base, while the timer
+	// interrupt enters at base + 4 * 7
+	__asm__ volatile ("csrw mtvec, %0" : : "r"((uint32_t)trap_vector | 1));
+
+	__asm__ volatile ("ecall");
+	check("vectored ecall", CAUSE_ECALL_M, 0);
+
+	int ticks = timer_ticks;
+	*((volatile uint32_t*)MTIMECMP) = *((volatile uint32_t*)MTIME) + 100;
+	*((volatile uint32_t*)(MTIMECMP + 4)) = 0;
+	__asm__ volatile ("csrs mie, %0" : : "r"(1 << 7));
+	__asm__ volatile ("csrs mstatus, %0" : : "r"(1 << 3));
+	for (int i = 0; i < 1000 && timer_ticks == ticks; i++)
+		;
+	__asm__ volatile ("csrc mstatus, %0" : : "r"(1 << 3));
+	__asm__ volatile ("csrc mie, %0" : : "r"(1 << 7));
+	if (!vectored_irq)
+		last_cause = 0;
+	check("vectored timer", CAUSE_IRQ_M_TIMER, 0);
+
+	// csrrw writes even when the source is x0
+	__asm__ volatile ("csrw mtvec, zero");
+	__asm__ volatile ("csrr %0, mtvec" : "=r"(val));
+	if (val != 0) {
+		print_str("ERROR in csrw x0: mtvec=");
+		print_hex(val, 8);
+		print_str("\n");
+		__asm__ volatile ("ebreak");
+	}
+
+	print_str("OK\n");
+}
@@ -0,0 +1,94 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "coverage.h"
+
+#include <cstdint>
+
+namespace {
+
+int Kind(const Retired &retired) {
+  const uint32_t inst = retired.inst;
+  const int f3 = (inst >> 12) & 7;
+  switch (inst & 0x7f) {
+    case 0x37: return 0;  // lui
+    case 0x17: return 1;  // auipc
+    case 0x6f: return 2;  // jal
+    case 0x67: return 3;  // jalr
+    case 0x63: return retired.taken ? 4 : 5;  // branch, taken or not
+    case 0x03:
+      if (f3 == 2) return 6;  // lw
+      return (f3 & 1) ? 7 : 8;  // lh/lhu, lb/lbu
+    case 0x23:
+      if (f3 == 2) return 9;  // sw
+      return (f3 & 1) ? 10 : 11;  // sh, sb
+    case 0x13: return (f3 == 1 || f3 == 5) ? 12 : 13;  // shift, other op-imm
+    case 0x33: return 14;  // op
+    default: return 15;  // everything else
+  }
+}
+
+// Returns whether `inst` has a destination register, and which it is.
+bool Dest(uint32_t inst, int *rd) {
+  const uint32_t op = inst & 0x7f;
+  *rd = (inst >> 7) & 31;
+  return *rd != 0 && op != 0x63 && op != 0x23 && op != 0x0f && op != 0x73;
+}
+
+bool ReadsRs1(uint32_t inst) {
+  const uint32_t op = inst & 0x7f;
+  return op != 0x37 && op != 0x17 && op != 0x6f && op != 0x0f;
+}
+
+bool ReadsRs2(uint32_t inst) {
+  const uint32_t op = inst & 0x7f;
+  return op == 0x63 || op == 0x23 || op == 0x33;
+}
+
+}  // namespace
+
+constexpr int PairCoverage::kKinds;
+constexpr int PairCoverage::kDeps;
+constexpr int PairCoverage::kPoints;
+
+int PairCoverage::Add(const std::vector<Retired> &trace) {
+  int added = 0;
+  for (size_t i = 1; i < trace.size(); i++) {
+    const uint32_t inst = trace[i].inst;
+    const int rs1 = (inst >> 15) & 31;
+    const int rs2 = (inst >> 20) & 31;
+    int dep = 0;
+    int rd;
+    if (Dest(trace[i - 1].inst, &rd)) {
+      if (ReadsRs1(inst) && rs1 == rd) dep |= 1;
+      if (ReadsRs2(inst) && rs2 == rd) dep |= 2;
+    }
+
+    const int pair = Kind(trace[i - 1]) * kKinds + Kind(trace[i]);
+    const int point = pair * kDeps + dep;
+    if (!hits_[point]) {
+      hits_[point] = true;
+      covered_++;
+      added++;
+    }
+  }
+  return added;
+}
@@ -0,0 +1,56 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Functional coverage of instruction pairs
+
+#ifndef BBQ_TESTS_FUZZ_COVERAGE_H_
+#define BBQ_TESTS_FUZZ_COVERAGE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "iss.h"
+
+// PairCoverage records which kinds of instructions retired back to back and
+// whether the second one read the result of the first, which is where
+// forwarding and hazard logic tends to break.
+class PairCoverage {
+ public:
+  PairCoverage() : hits_(kPoints, false) {}
+
+  // Records the pairs in `trace`. Returns the number of new pairs.
+  int Add(const std::vector<Retired> &trace);
+
+  int covered() const { return covered_; }
+  static constexpr int points() { return kPoints; }
+
+ private:
+  // instruction kinds, see Kind() in coverage.cc
+  static constexpr int kKinds = 16;
+  // no dependency, on rs1, on rs2, on both
+  static constexpr int kDeps = 4;
+  static constexpr int kPoints = kKinds * kKinds * kDeps;
+
+  std::vector<bool> hits_;
+  int covered_ = 0;
+};
+
+#endif  // BBQ_TESTS_FUZZ_COVERAGE_H_
@@ -0,0 +1,252 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Differential fuzzer for barbecue
+//
+// Generates random RV32I programs, runs each of them on the core and on a
+// reference instruction set simulator, and compares the registers and data
+// memory they leave behind. Programs that retire new pairs of instructions are
+// kept and mutated to reach further. The first failing program is minimized
+// by replacing instructions with nops while it keeps failing, and written to
+// +out as a hex file.
+//
+//   +seed=<n>        random seed
+//   +iterations=<n>  number of programs to run
+//   +length=<n>      number of random instructions per program
+//   +coverage=<path> where to write the Verilator coverage data
+//   +out=<path>      where to write the failing program
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <verilated.h>
+#include <verilated_cov.h>
+
+#include "Vfuzz.h"
+#include "coverage.h"
+#include "generator.h"
+#include "iss.h"
+#include "sparse_memory.h"
+
+namespace {
+
+constexpr int kStartupWaitTime = 3;  // clocks
+constexpr uint64_t kMaxSteps = 100000;
+constexpr int kMutatePercent = 70;
+
+std::unique_ptr<Vfuzz> top;
+double main_time = 0;
+
+std::string PlusArg(const char *name, const std::string &fallback) {
+  const std::string prefix = std::string(name) + "=";
+  const std::string match = Verilated::commandArgsPlusMatch(prefix.c_str());
+  if (match.empty()) return fallback;
+  return match.substr(prefix.size() + 1);
+}
+
+// Returns whether a generated program may access `size` bytes at `addr`.
+bool ValidData(uint32_t addr, int size) {
+  if (addr % size != 0) return false;
+  return (addr >= kDataBase && addr < kDataBase + kDataSize) ||
+         (addr >= kSignatureBase && addr < kSignatureBase + kSignatureSize) ||
+         addr == kTestStatusAddr;
+}
+
+void LoadProgram(const Program &program, SparseMemory *memory) {
+  memory->Clear();
+  for (size_t i = 0; i < program.words.size(); i++) {
+    memory->Write(i * 4, program.words[i], ~0u);
+  }
+}
+
+void Tick() {
+  top->clk = 1;
+  top->eval();
+  main_time++;
+  top->clk = 0;
+  top->eval();
+  main_time++;
+}
+
+// Runs `program` on the reference model. Returns false if the program is not
+// valid, for example after minimizing away the auipc of a pair.
+bool RunReference(const Program &program, SparseMemory *memory,
+                  std::vector<Retired> *trace, uint64_t *steps) {
+  LoadProgram(program, memory);
+  Iss iss(memory);
+  iss.Restrict(program.words.size() * 4, ValidData);
+  Iss::Observer observer;
+  if (trace != nullptr) {
+    observer = [trace](const Retired &retired) { trace->push_back(retired); };
+  }
+  const bool halted = iss.Run(kMaxSteps, observer) == Iss::Status::kHalted;
+  *steps = iss.steps();
+  return halted;
+}
+
+// Runs `program` on the core. Returns whether the core reported success and
+// halted within `max_cycles`.
+bool RunCore(const Program &program, uint64_t max_cycles) {
+  LoadProgram(program, &SparseMemory::Instance());
+
+  top->reset = 1;
+  for (int i = 0; i < kStartupWaitTime; i++) Tick();
+  top->reset = 0;
+
+  for (uint64_t cycle = 0; cycle < max_cycles && !top->error; cycle++) Tick();
+  return top->error && top->test_passed;
+}
+
+// Compares the data and signature areas of both memories. Mismatches are
+// printed if `verbose` is set.
+bool Compare(const SparseMemory &expected, const SparseMemory &actual,
+             bool verbose) {
+  bool match = true;
+  auto compare = [&](uint32_t base, uint32_t size) {
+    for (uint32_t addr = base; addr < base + size; addr += 4) {
+      if (expected.Read(addr) == actual.Read(addr)) continue;
+      match = false;
+      if (verbose) {
+        std::printf("  0x%08" PRIx32 ": expected 0x%08" PRIx32
+                    ", got 0x%08" PRIx32 "\n",
+                    addr, expected.Read(addr), actual.Read(addr));
+      }
+    }
+  };
+  compare(kSignatureBase, kSignatureSize);
+  compare(kDataBase, kDataSize);
+  return match;
+}
+
+// Returns whether `program` is valid and gives different results on the core
+// and on the reference model.
+bool Fails(const Program &program, bool verbose) {
+  SparseMemory expected;
+  uint64_t steps;
+  if (!RunReference(program, &expected, nullptr, &steps)) return false;
+
+  if (!RunCore(program, 2 * steps + 100)) {
+    if (verbose) std::printf("  the core did not finish\n");
+    return true;
+  }
+  return !Compare(expected, SparseMemory::Instance(), verbose);
+}
+
+Program Minimize(Program program) {
+  bool shrunk = true;
+  while (shrunk) {
+    shrunk = false;
+    for (size_t i = program.body_begin; i < program.body_end; i++) {
+      if (program.words[i] == kNop) continue;
+      const uint32_t saved = program.words[i];
+      program.words[i] = kNop;
+      if (Fails(program, false)) shrunk = true;
+      else program.words[i] = saved;
+    }
+  }
+  return program;
+}
+
+void WriteHex(const Program &program, const std::string &path) {
+  FILE *file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) return;
+  for (uint32_t word : program.words) {
+    std::fprintf(file, "%08" PRIx32 "\n", word);
+  }
+  std::fclose(file);
+}
+
+}  // namespace
+
+double sc_time_stamp() { return main_time; }
+
+int main(int argc, char *argv[]) {
+  Verilated::commandArgs(argc, argv);
+
+  const uint32_t seed = std::stoul(PlusArg("seed", "1"));
+  const int iterations = std::stoi(PlusArg("iterations", "1000"));
+  const int length = std::stoi(PlusArg("length", "200"));
+  const std::string coverage_path = PlusArg("coverage", "coverage.dat");
+  const std::string out_path = PlusArg("out", "fuzz-failure.hex");
+
+  top.reset(new Vfuzz());
+  top->clk = 0;
+
+  Generator generator(seed);
+  std::mt19937 rng(seed);
+  PairCoverage coverage;
+  std::vector<Program> corpus;
+  int invalid = 0;
+  int status = 0;
+  int i;
+
+  for (i = 0; i < iterations; i++) {
+    Program program;
+    if (!corpus.empty() && std::uniform_int_distribution<int>(0, 99)(rng) <
+                               kMutatePercent) {
+      program = corpus[rng() % corpus.size()];
+      generator.Mutate(&program);
+    } else {
+      program = generator.Generate(length);
+    }
+
+    SparseMemory expected;
+    std::vector<Retired> trace;
+    uint64_t steps;
+    if (!RunReference(program, &expected, &trace, &steps)) {
+      invalid++;
+      continue;
+    }
+    const bool covers_new_pairs = coverage.Add(trace) > 0;
+
+    if (!RunCore(program, 2 * steps + 100) ||
+        !Compare(expected, SparseMemory::Instance(), false)) {
+      std::printf("fuzz: program %d (seed %" PRIu32 ") failed\n", i, seed);
+      const Program minimized = Minimize(program);
+      Fails(minimized, true);
+      WriteHex(minimized, out_path);
+      std::printf("fuzz: minimized program written to %s\n",
+                  out_path.c_str());
+      status = 1;
+      break;
+    }
+
+    if (covers_new_pairs) corpus.push_back(program);
+  }
+
+  std::printf("fuzz: %d programs, %d invalid, %zu in corpus, "
+              "%d/%d instruction pairs covered\n",
+              i, invalid, corpus.size(), coverage.covered(),
+              PairCoverage::points());
+
+  top->final();
+#if VM_COVERAGE
+  Verilated::threadContextp()->coveragep()->write(coverage_path.c_str());
+#endif
+  top.reset();
+
+  return status;
+}
@@ -0,0 +1,233 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "generator.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint32_t kOpLoad = 0x03;
+constexpr uint32_t kOpMiscMem = 0x0f;
+constexpr uint32_t kOpImm = 0x13;
+constexpr uint32_t kOpAuipc = 0x17;
+constexpr uint32_t kOpStore = 0x23;
+constexpr uint32_t kOp = 0x33;
+constexpr uint32_t kOpLui = 0x37;
+constexpr uint32_t kOpBranch = 0x63;
+constexpr uint32_t kOpJalr = 0x67;
+constexpr uint32_t kOpJal = 0x6f;
+constexpr uint32_t kEbreak = 0x00100073;
+
+constexpr int kRecentRegs = 4;
+
+uint32_t EncodeR(uint32_t op, int f3, int f7, int rd, int rs1, int rs2) {
+  return f7 << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op;
+}
+
+uint32_t EncodeI(uint32_t op, int f3, int rd, int rs1, int32_t imm) {
+  return (imm & 0xfff) << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op;
+}
+
+uint32_t EncodeS(int f3, int rs1, int rs2, int32_t imm) {
+  return ((imm >> 5) & 0x7f) << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 |
+         (imm & 0x1f) << 7 | kOpStore;
+}
+
+uint32_t EncodeB(int f3, int rs1, int rs2, int32_t imm) {
+  return ((imm >> 12) & 1) << 31 | ((imm >> 5) & 0x3f) << 25 | rs2 << 20 |
+         rs1 << 15 | f3 << 12 | ((imm >> 1) & 0xf) << 8 |
+         ((imm >> 11) & 1) << 7 | kOpBranch;
+}
+
+uint32_t EncodeU(uint32_t op, int rd, uint32_t imm) {
+  return (imm & 0xfffff000) | rd << 7 | op;
+}
+
+uint32_t EncodeJ(int rd, int32_t imm) {
+  return ((imm >> 20) & 1) << 31 | ((imm >> 1) & 0x3ff) << 21 |
+         ((imm >> 11) & 1) << 20 | ((imm >> 12) & 0xff) << 12 | rd << 7 |
+         kOpJal;
+}
+
+int32_t DecodeB(uint32_t word) {
+  return static_cast<int32_t>(word & 0x80000000) >> 19 |
+         (word & 0x80) << 4 | (word >> 20 & 0x7e0) | (word >> 7 & 0x1e);
+}
+
+int32_t DecodeJ(uint32_t word) {
+  return static_cast<int32_t>(word & 0x80000000) >> 11 | (word & 0xff000) |
+         (word >> 9 & 0x800) | (word >> 20 & 0x7fe);
+}
+
+void EmitLoadImm(std::vector<uint32_t> *words, int rd, uint32_t value) {
+  words->push_back(EncodeU(kOpLui, rd, value + 0x800));
+  words->push_back(EncodeI(kOpImm, 0, rd, rd, value & 0xfff));
+}
+
+}  // namespace
+
+Program Generator::Generate(int length) {
+  Program program;
+  recent_.clear();
+
+  for (int rd = 1; rd < 32; rd++) {
+    uint32_t value = rng_();
+    if (rd == kBaseReg) value = kDataBase;
+    else if (Chance(25)) value = Uniform(-8, 8);
+    EmitLoadImm(&program.words, rd, value);
+  }
+
+  program.body_begin = program.words.size();
+  program.body_end = program.body_begin + length;
+  program.words.resize(program.body_end, kNop);
+  for (size_t pos = program.body_begin; pos < program.body_end;) {
+    pos += Fill(&program, pos);
+  }
+  Retarget(&program);
+
+  EmitLoadImm(&program.words, kBaseReg, kSignatureBase);
+  for (int rs = 1; rs < 32; rs++) {
+    program.words.push_back(EncodeS(2, kBaseReg, rs, rs * 4));
+  }
+  EmitLoadImm(&program.words, 1, kTestStatusAddr);
+  EmitLoadImm(&program.words, 2, kTestPassValue);
+  program.words.push_back(EncodeS(2, 1, 2, 0));
+  program.words.push_back(kEbreak);
+
+  return program;
+}
+
+void Generator::Mutate(Program *program) {
+  recent_.clear();
+  const int length = program->body_end - program->body_begin;
+  const int count = Uniform(1, 4);
+  for (int i = 0; i < count; i++) {
+    size_t pos = program->body_begin + Uniform(0, length - 1);
+    // Replace a pair as a whole rather than split it.
+    if (program->pairs.count(pos - 1)) pos--;
+    if (program->pairs.erase(pos)) program->words[pos + 1] = kNop;
+    Fill(program, pos);
+  }
+  Retarget(program);
+}
+
+void Generator::Retarget(Program *program) {
+  auto lands_on_jalr = [program](size_t pos, int32_t offset) {
+    return program->pairs.count(pos + offset / 4 - 1) != 0;
+  };
+  for (size_t pos = program->body_begin; pos < program->body_end; pos++) {
+    uint32_t &word = program->words[pos];
+    const uint32_t op = word & 0x7f;
+    if (op == kOpBranch && lands_on_jalr(pos, DecodeB(word))) {
+      word = EncodeB(word >> 12 & 7, word >> 15 & 31, word >> 20 & 31,
+                     DecodeB(word) + 4);
+    } else if (op == kOpJal && lands_on_jalr(pos, DecodeJ(word))) {
+      word = EncodeJ(word >> 7 & 31, DecodeJ(word) + 4);
+    } else if (program->pairs.count(pos)) {
+      // The jalr jumps relative to the auipc.
+      uint32_t &jalr = program->words[pos + 1];
+      const int32_t offset = static_cast<int32_t>(jalr) >> 20;
+      if (lands_on_jalr(pos, offset)) {
+        jalr = EncodeI(kOpJalr, 0, jalr >> 7 & 31, jalr >> 15 & 31,
+                       offset + 4);
+      }
+      pos++;
+    }
+  }
+}
+
+int Generator::Fill(Program *program, size_t pos) {
+  uint32_t &word = program->words[pos];
+  // Branch targets lie after `pos`, up to the start of the epilogue.
+  const int max_skip = std::min<int>(program->body_end - pos, 500);
+
+  const int kind = Uniform(0, 99);
+  if (kind < 25) {
+    static const int kFunct3[] = {0, 0, 1, 2, 3, 4, 5, 5, 6, 7};
+    const int f3 = kFunct3[Uniform(0, 9)];
+    const bool alt = (f3 == 0 || f3 == 5) && Chance(50);
+    const int rs1 = PickSource();
+    const int rs2 = PickSource();
+    word = EncodeR(kOp, f3, alt ? 0x20 : 0, PickDest(), rs1, rs2);
+  } else if (kind < 50) {
+    const int f3 = Uniform(0, 7);
+    int32_t imm = Chance(50) ? Uniform(-2048, 2047) : Uniform(-4, 4);
+    if (f3 == 1) imm = Uniform(0, 31);
+    if (f3 == 5) imm = Uniform(0, 31) | (Chance(50) ? 0x400 : 0);
+    const int rs1 = PickSource();
+    word = EncodeI(kOpImm, f3, PickDest(), rs1, imm);
+  } else if (kind < 55) {
+    word = EncodeU(Chance(50) ? kOpLui : kOpAuipc, PickDest(), rng_());
+  } else if (kind < 70) {
+    static const int kFunct3[] = {0, 1, 2, 4, 5};
+    const int f3 = kFunct3[Uniform(0, 4)];
+    const int size = 1 << (f3 & 3);
+    const int32_t offset = Uniform(0, kDataSize / size - 1) * size;
+    const int rd = PickDest();
+    word = EncodeI(kOpLoad, f3, rd, kBaseReg, offset);
+    // Make the next instruction a likely load-use hazard.
+    recent_.push_front(rd);
+  } else if (kind < 82) {
+    const int f3 = Uniform(0, 2);
+    const int size = 1 << f3;
+    const int32_t offset = Uniform(0, kDataSize / size - 1) * size;
+    word = EncodeS(f3, kBaseReg, PickSource(), offset);
+  } else if (kind < 94) {
+    static const int kFunct3[] = {0, 1, 4, 5, 6, 7};
+    const int rs1 = PickSource();
+    const int rs2 = PickSource();
+    word = EncodeB(kFunct3[Uniform(0, 5)], rs1, rs2,
+                   Uniform(1, max_skip) * 4);
+  } else if (kind < 97) {
+    word = EncodeJ(PickDest(), Uniform(1, max_skip) * 4);
+  } else if (kind < 99 && max_skip >= 2 && !program->pairs.count(pos + 1)) {
+    // auipc/jalr pair jumping forward relative to the auipc. The base is
+    // never x0, which would make the jalr jump to an absolute address.
+    const int base = PickDest(false);
+    word = EncodeU(kOpAuipc, base, 0);
+    program->words[pos + 1] =
+        EncodeI(kOpJalr, 0, PickDest(), base, Uniform(2, max_skip) * 4);
+    program->pairs.insert(pos);
+    return 2;
+  } else {
+    word = EncodeI(kOpMiscMem, 0, 0, 0, 0x0ff);
+  }
+  return 1;
+}
+
+int Generator::Uniform(int lo, int hi) {
+  return std::uniform_int_distribution<int>(lo, hi)(rng_);
+}
+
+int Generator::PickSource() {
+  if (!recent_.empty() && Chance(60)) {
+    return recent_[Uniform(0, recent_.size() - 1)];
+  }
+  return Uniform(0, 31);
+}
+
+int Generator::PickDest(bool allow_zero) {
+  const int rd = allow_zero && Chance(5) ? 0 : Uniform(1, kBaseReg - 1);
+  recent_.push_front(rd);
+  if (recent_.size() > kRecentRegs) recent_.pop_back();
+  return rd;
+}
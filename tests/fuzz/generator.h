@@ -0,0 +1,88 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Constrained-random RV32I programs for differential testing
+
+#ifndef BBQ_TESTS_FUZZ_GENERATOR_H_
+#define BBQ_TESTS_FUZZ_GENERATOR_H_
+
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <set>
+#include <vector>
+
+// Memory layout of the generated programs. The code starts at address zero.
+constexpr uint32_t kDataBase = 0x10000;
+constexpr uint32_t kDataSize = 0x100;
+constexpr uint32_t kSignatureBase = 0x20000;
+constexpr uint32_t kSignatureSize = 32 * 4;
+constexpr uint32_t kTestStatusAddr = 0x20000000;
+constexpr uint32_t kTestPassValue = 123456789;
+
+// The register holding kDataBase. The random body never writes to it.
+constexpr int kBaseReg = 31;
+
+constexpr uint32_t kNop = 0x00000013;  // addi x0, x0, 0
+
+// A program consists of a prologue that loads random values into every
+// register, a random body, and an epilogue that stores every register to the
+// signature area, reports success to the testbench and halts with ebreak.
+// Control flow in the body only moves forward, so every program terminates.
+// The jalr of an auipc/jalr pair is never a jump target, so it always sees
+// the address its auipc computed.
+struct Program {
+  std::vector<uint32_t> words;
+  size_t body_begin;
+  size_t body_end;
+  // Positions of the auipc of every auipc/jalr pair in the body
+  std::set<size_t> pairs;
+};
+
+class Generator {
+ public:
+  explicit Generator(uint32_t seed) : rng_(seed) {}
+
+  Program Generate(int length);
+
+  // Replaces a few instructions of the body with new random ones.
+  void Mutate(Program *program);
+
+ private:
+  // Fills the body from `pos` with one instruction, or two for the
+  // auipc/jalr pair. Returns the number of instructions written.
+  int Fill(Program *program, size_t pos);
+
+  // Moves jumps that land on the jalr of a pair to the instruction after it.
+  void Retarget(Program *program);
+
+  int Uniform(int lo, int hi);
+  bool Chance(int percent) { return Uniform(0, 99) < percent; }
+  int PickSource();
+  int PickDest(bool allow_zero = true);
+
+  std::mt19937 rng_;
+  // Recently written registers, most recent first. Sources are picked from
+  // them to create back-to-back dependencies.
+  std::deque<int> recent_;
+};
+
+#endif  // BBQ_TESTS_FUZZ_GENERATOR_H_
@@ -0,0 +1,69 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file defines intrinsics for the puzzle unit of the core. See
+// src/puzzle_unit.v for the instructions. They are only available with
+// BBQ_CUSTOM on boards of up to 16 tiles.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "puzzle.h"
+
+#if defined(BBQ_CUSTOM) && defined(PACKED_BOARD)
+
+#define HAVE_PUZZLE_UNIT
+
+// Returns the Manhattan distance of a 3x3 board.
+static inline int pz_dist(uint64_t tiles) {
+  uint32_t dist;
+  asm(".insn r CUSTOM_0, 0, 0, %0, %1, %2"
+      : "=r"(dist)
+      : "r"((uint32_t)tiles), "r"((uint32_t)(tiles >> 32)));
+  return dist;
+}
+
+// Moves the tile at position `from` to the blank at position `to`. Only moves
+// between the two halves of the board need the tile from pz.get and a pz.move
+// on each half.
+static inline uint64_t pz_move(uint64_t tiles, int from, int to) {
+  uint32_t lo = tiles;
+  uint32_t hi = tiles >> 32;
+  uint32_t tile, move = (from << 4) | to;
+
+  if ((from | to) < 8) {
+    asm(".insn r CUSTOM_0, 2, 0, %0, %1, %2" : "=r"(lo) : "r"(lo), "r"(move));
+  } else if ((from & to) >= 8) {
+    asm(".insn r CUSTOM_0, 2, 1, %0, %1, %2" : "=r"(hi) : "r"(hi), "r"(move));
+  } else {
+    asm(".insn r CUSTOM_0, 1, 0, %0, %1, %2"
+        : "=r"(tile)
+        : "r"(from < 8 ? lo : hi), "r"(from));
+    move |= tile << 8;
+    asm(".insn r CUSTOM_0, 2, 0, %0, %1, %2" : "=r"(lo) : "r"(lo), "r"(move));
+    asm(".insn r CUSTOM_0, 2, 1, %0, %1, %2" : "=r"(hi) : "r"(hi), "r"(move));
+  }
+
+  return ((uint64_t)hi << 32) | lo;
+}
+
+#endif  // defined(BBQ_CUSTOM) && defined(PACKED_BOARD)
@@ -0,0 +1,434 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Solves a corpus of boards natively on every core of the host, as a
+// throughput baseline for the simulated core.
+//
+// Boards are solved in parallel on a work-stealing thread pool. Once an IDA*
+// iteration of a board expands more than kSplitNodes boards, each of its
+// following iterations is split into one task per pair of leading moves like
+// the multi-hart solver does, so that a single hard board keeps every thread
+// busy.
+//
+// Usage: batch [-j threads] [-c answers] [corpus]
+//
+// The corpus is either a binary corpus from generate-corpus or the tiles of
+// each board in row-major order as printed by generate-board.py, and is read
+// from stdin if omitted. Boards labeled with their optimal length are checked
+// against it. The solutions are printed in the order of the corpus. With -c,
+// the lines of `answers` made of moves are taken as the output of the simulated
+// core for the boards in the same order, and each is checked to solve its board
+// in the fewest moves.
+
+extern "C" {
+#include "puzzle.h"
+}
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "corpus.h"
+
+namespace {
+
+constexpr uint64_t kSplitNodes = 1 << 16;
+constexpr int kNumMoves = MOVE_SIZE - MOVE_FIRST;
+constexpr int kNumJobs = kNumMoves * kNumMoves;
+
+// A thread pool where every thread runs tasks from the back of its own queue
+// and steals from the front of the others' when it runs dry. The thread that
+// creates the pool takes part as thread 0.
+class Pool {
+ public:
+  explicit Pool(int nthreads);
+  ~Pool();
+
+  // Queues a task on the calling thread.
+  void Push(std::function<void()> task);
+
+  // Runs tasks until `pending` drops to zero.
+  void Wait(const std::atomic<int> &pending);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  bool RunOne();
+  void Loop(int index);
+
+  static thread_local int index_;
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+  std::atomic<int> queued_{0};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+};
+
+thread_local int Pool::index_ = 0;
+
+Pool::Pool(int nthreads) {
+  for (int i = 0; i < nthreads; i++) queues_.emplace_back(new Queue);
+  for (int i = 1; i < nthreads; i++) threads_.emplace_back(&Pool::Loop, this, i);
+}
+
+Pool::~Pool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) thread.join();
+}
+
+void Pool::Push(std::function<void()> task) {
+  Queue &queue = *queues_[index_];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_++;
+  }
+  cv_.notify_one();
+}
+
+bool Pool::RunOne() {
+  const int n = queues_.size();
+  std::function<void()> task;
+  for (int i = 0; i < n && !task; i++) {
+    Queue &queue = *queues_[(index_ + i) % n];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) continue;
+    if (i == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+  }
+  if (!task) return false;
+
+  queued_--;
+  task();
+  return true;
+}
+
+void Pool::Wait(const std::atomic<int> &pending) {
+  while (pending.load(std::memory_order_acquire) > 0) {
+    if (!RunOne()) std::this_thread::yield();
+  }
+}
+
+void Pool::Loop(int index) {
+  index_ = index;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || queued_ > 0; });
+      if (stop_) return;
+    }
+    RunOne();
+  }
+}
+
+struct Result {
+  mstack_t solution = {};
+  uint64_t nodes = 0;
+  bool solved = false;
+};
+
+void UpdateMin(std::atomic<int> *min, int value) {
+  int curr = min->load(std::memory_order_relaxed);
+  while (value < curr && !min->compare_exchange_weak(curr, value)) {
+  }
+}
+
+// Runs one IDA* iteration as kNumJobs tasks on the pool.
+int SolveSplit(Pool *pool, const board_t &board, int max_cost,
+               Result *result) {
+  std::vector<mstack_t> answers(kNumJobs, mstack_t());
+  std::atomic<int> pending(kNumJobs);
+  std::atomic<int> min_cost(INF);
+  std::atomic<int> solved_job(-1);
+  std::atomic<uint64_t> nodes(0);
+
+  for (int job = 0; job < kNumJobs; job++) {
+    pool->Push([&, job] {
+      if (solved_job.load(std::memory_order_relaxed) < 0) {
+        const move_t first = static_cast<move_t>(MOVE_FIRST + job / kNumMoves);
+        const move_t second =
+            static_cast<move_t>(MOVE_FIRST + job % kNumMoves);
+        const uint64_t before = g_nodes;
+        const int cost =
+            solve_subtree(&board, first, second, max_cost, &answers[job]);
+        nodes += g_nodes - before;
+        if (cost == 0) {
+          solved_job = job;
+        } else {
+          UpdateMin(&min_cost, cost);
+        }
+      }
+      pending.fetch_sub(1, std::memory_order_release);
+    });
+  }
+  pool->Wait(pending);
+
+  result->nodes += nodes;
+  if (solved_job >= 0) {
+    result->solution = answers[solved_job];
+    return 0;
+  }
+  return min_cost;
+}
+
+void SolveBoard(Pool *pool, board_t board, Result *result) {
+  init_board(&board);
+  if (board.is_goal) {
+    result->solved = true;
+    return;
+  }
+
+  bool split = false;
+  int max_cost = heuristic(&board);
+  while (max_cost < MAX_DEPTH) {
+    int min_cost;
+    if (split) {
+      min_cost = SolveSplit(pool, board, max_cost, result);
+    } else {
+      const uint64_t before = g_nodes;
+      min_cost = solve(&board, max_cost, &result->solution);
+      result->nodes += g_nodes - before;
+      split = g_nodes - before > kSplitNodes;
+    }
+
+    if (min_cost == 0) {
+      result->solved = true;
+      return;
+    }
+    max_cost = min_cost;
+  }
+}
+
+// Reads a binary corpus or the text printed by generate-board.py, where
+// comments run from '#' to the end of the line.
+bool LoadCorpus(std::istream &in, std::vector<CorpusBoard> *boards) {
+  if (IsBinaryCorpus(in)) return ReadCorpus(in, SIZE, boards);
+
+  CorpusBoard board = {};
+  board.length = kUnknownLength;
+  int ntiles = 0;
+  std::string token;
+  while (in >> token) {
+    if (token[0] == '#') {
+      std::getline(in, token);
+      continue;
+    }
+    board.tiles[ntiles++] = std::atoi(token.c_str());
+    if (ntiles == SIZE * SIZE) {
+      boards->push_back(board);
+      ntiles = 0;
+    }
+  }
+  return ntiles == 0;
+}
+
+std::vector<std::string> LoadAnswers(std::istream &in) {
+  std::vector<std::string> answers;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty() &&
+        line.find_first_not_of("UDRL") == std::string::npos) {
+      answers.push_back(line);
+    }
+  }
+  return answers;
+}
+
+std::string ToString(const mstack_t &moves) {
+  static const char kDirections[] = "?UDRL";
+  std::string str;
+  for (size_t i = moves.len; i > 0; i--) str += kDirections[moves.moves[i - 1]];
+  return str;
+}
+
+// Returns whether `moves` takes `board` to the goal. The moves are those of
+// apply_move in puzzle.c.
+bool Replay(board_t board, const std::string &moves) {
+  init_board(&board);
+  int x = board.empty_tile[0];
+  int y = board.empty_tile[1];
+  for (char move : moves) {
+    int dst_x = x, dst_y = y;
+    switch (move) {
+      case 'U': dst_y++; break;
+      case 'D': dst_y--; break;
+      case 'R': dst_x--; break;
+      case 'L': dst_x++; break;
+    }
+    if (dst_x < 0 || dst_x >= SIZE || dst_y < 0 || dst_y >= SIZE) return false;
+    set_tile(&board, x, y, get_tile(&board, dst_x, dst_y));
+    set_tile(&board, dst_x, dst_y, 0);
+    x = dst_x;
+    y = dst_y;
+  }
+
+  for (int i = 0; i < SIZE * SIZE - 1; i++) {
+    if (get_tile(&board, i % SIZE, i / SIZE) != i + 1) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int nthreads = std::max(1u, std::thread::hardware_concurrency());
+  const char *answers_path = nullptr;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "j:c:")) != -1) {
+    switch (opt) {
+      case 'j':
+        nthreads = std::max(1, std::atoi(optarg));
+        break;
+      case 'c':
+        answers_path = optarg;
+        break;
+      default:
+        std::fprintf(stderr, "usage: %s [-j threads] [-c answers] [corpus]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<CorpusBoard> corpus;
+  bool loaded;
+  if (optind < argc) {
+    std::ifstream in(argv[optind], std::ios::binary);
+    if (!in) {
+      std::fprintf(stderr, "batch: can't open %s\n", argv[optind]);
+      return EXIT_FAILURE;
+    }
+    loaded = LoadCorpus(in, &corpus);
+  } else {
+    loaded = LoadCorpus(std::cin, &corpus);
+  }
+  if (!loaded) {
+    std::fprintf(stderr, "batch: malformed corpus\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<board_t> boards(corpus.size(), board_t());
+  for (size_t i = 0; i < corpus.size(); i++) {
+    for (int j = 0; j < SIZE * SIZE; j++) {
+      set_tile(&boards[i], j % SIZE, j / SIZE, corpus[i].tiles[j]);
+    }
+  }
+
+  std::vector<Result> results(boards.size());
+  const auto start = std::chrono::steady_clock::now();
+  {
+    Pool pool(nthreads);
+    std::atomic<int> pending(boards.size());
+    for (size_t i = 0; i < boards.size(); i++) {
+      pool.Push([&, i] {
+        SolveBoard(&pool, boards[i], &results[i]);
+        pending.fetch_sub(1, std::memory_order_release);
+      });
+    }
+    pool.Wait(pending);
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  bool ok = true;
+  uint64_t nodes = 0;
+  for (size_t i = 0; i < results.size(); i++) {
+    if (!results[i].solved) {
+      std::fprintf(stderr, "board %zu: no solution\n", i);
+      ok = false;
+    } else if (corpus[i].length != kUnknownLength &&
+               corpus[i].length != results[i].solution.len) {
+      std::fprintf(stderr, "board %zu: %zu moves, labeled %d\n", i,
+                   results[i].solution.len, corpus[i].length);
+      ok = false;
+    }
+    std::printf("%s\n", ToString(results[i].solution).c_str());
+    nodes += results[i].nodes;
+  }
+
+  const double seconds = elapsed.count();
+  std::fprintf(stderr, "threads: %d\n", nthreads);
+  std::fprintf(stderr, "boards: %zu\n", boards.size());
+  std::fprintf(stderr, "nodes: %llu\n", (unsigned long long)nodes);
+  std::fprintf(stderr, "time: %.3f s\n", seconds);
+  std::fprintf(stderr, "boards/sec: %.1f\n", boards.size() / seconds);
+  std::fprintf(stderr, "nodes/sec: %.0f\n", nodes / seconds);
+
+  if (answers_path) {
+    std::ifstream in(answers_path);
+    if (!in) {
+      std::fprintf(stderr, "batch: can't open %s\n", answers_path);
+      return EXIT_FAILURE;
+    }
+    const std::vector<std::string> answers = LoadAnswers(in);
+    if (answers.size() != boards.size()) {
+      std::fprintf(stderr, "check: %zu answers for %zu boards\n",
+                   answers.size(), boards.size());
+      ok = false;
+    }
+    for (size_t i = 0; i < std::min(answers.size(), boards.size()); i++) {
+      if (!Replay(boards[i], answers[i])) {
+        std::fprintf(stderr, "check: board %zu: answer does not solve it\n",
+                     i);
+        ok = false;
+      } else if (answers[i].size() != results[i].solution.len) {
+        std::fprintf(stderr, "check: board %zu: %zu moves, optimal is %zu\n",
+                     i, answers[i].size(), results[i].solution.len);
+        ok = false;
+      }
+    }
+    std::fprintf(stderr, "check: %s\n", ok ? "ok" : "failed");
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
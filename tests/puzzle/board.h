@@ -27,28 +27,48 @@
 #include "puzzle.h"
 
 
-#ifdef BBQ_SIMULATION
+// Simulations solve the board compiled in from problem.h, unless built with
+// BBQ_CONSOLE_INPUT to read boards from the console like native builds do.
+// load_board() returns false once there are no more boards.
+
+#ifdef BBQ_TCM_BOARD
+#include "../tcm.h"
+
+// Declared first so that the definition below lands in the scratchpad.
+extern board_t g_board BBQ_TCM;
+#endif
+
+#if defined(BBQ_SIMULATION) && !defined(BBQ_CONSOLE_INPUT)
 
 #include "problem.h"
 
-static inline void load_board() {}
+static inline bool load_board() {
+  static bool loaded = false;
+  const bool first = !loaded;
+  loaded = true;
+  return first;
+}
 
-#else  // BBQ_SIMULATION
+#else  // BBQ_SIMULATION && !BBQ_CONSOLE_INPUT
 
 #include <stdio.h>
 
 board_t g_board;
 
-void load_board(board_t* board);
+bool load_board(board_t* board);
 
-void load_board(board_t* board) {
+// Reads the tiles of a board in row-major order, separated by whitespace.
+bool load_board(board_t* board) {
   for (int i = 0; i < SIZE; i++) {
     for (int j = 0; j < SIZE; j++) {
-      scanf("%d", &board->board[i][j]);
+      int val;
+      if (scanf("%d", &val) != 1) return false;
+      set_tile(board, j, i, val);
     }
   }
+  return true;
 }
 
-#endif  // BBQ_SIMULATION
+#endif  // BBQ_SIMULATION && !BBQ_CONSOLE_INPUT
 
 #pragma GCC diagnostic pop
@@ -0,0 +1,95 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "corpus.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr char kMagic[4] = {'B', 'B', 'Q', 'C'};
+constexpr uint8_t kVersion = 1;
+
+int TileBits(int width) { return width * width <= 16 ? 4 : 5; }
+
+int RecordSize(int width) {
+  return (width * width * TileBits(width) + 7) / 8 + 1;
+}
+
+}  // namespace
+
+bool IsBinaryCorpus(std::istream &in) { return in.peek() == kMagic[0]; }
+
+bool WriteCorpus(FILE *out, int width, const std::vector<CorpusBoard> &boards) {
+  const uint32_t count = boards.size();
+  uint8_t header[12];
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  header[4] = width;
+  header[5] = kVersion;
+  header[6] = header[7] = 0;
+  for (int i = 0; i < 4; i++) header[8 + i] = count >> (8 * i);
+  if (std::fwrite(header, sizeof(header), 1, out) != 1) return false;
+
+  const int bits = TileBits(width);
+  const int size = RecordSize(width);
+  std::vector<uint8_t> buf(size * boards.size());
+  for (size_t b = 0; b < boards.size(); b++) {
+    uint8_t *record = &buf[b * size];
+    for (int i = 0; i < width * width; i++) {
+      const int pos = i * bits;
+      const unsigned tile = boards[b].tiles[i] << (pos % 8);
+      record[pos / 8] |= tile;
+      if (tile >> 8) record[pos / 8 + 1] |= tile >> 8;
+    }
+    record[size - 1] = boards[b].length;
+  }
+  return std::fwrite(buf.data(), 1, buf.size(), out) == buf.size();
+}
+
+bool ReadCorpus(std::istream &in, int width, std::vector<CorpusBoard> *boards) {
+  uint8_t header[12];
+  if (!in.read(reinterpret_cast<char *>(header), sizeof(header))) return false;
+  if (std::memcmp(header, kMagic, sizeof(kMagic)) != 0 ||
+      header[4] != width || header[5] != kVersion) {
+    return false;
+  }
+
+  uint32_t count = 0;
+  for (int i = 0; i < 4; i++) count |= header[8 + i] << (8 * i);
+
+  const int bits = TileBits(width);
+  const int size = RecordSize(width);
+  std::vector<uint8_t> record(size);
+  for (uint32_t b = 0; b < count; b++) {
+    if (!in.read(reinterpret_cast<char *>(record.data()), size)) return false;
+
+    CorpusBoard board = {};
+    for (int i = 0; i < width * width; i++) {
+      const int pos = i * bits;
+      unsigned word = record[pos / 8];
+      if (pos / 8 + 1 < size) word |= record[pos / 8 + 1] << 8;
+      board.tiles[i] = (word >> (pos % 8)) & ((1u << bits) - 1);
+    }
+    board.length = record[size - 1];
+    boards->push_back(board);
+  }
+  return true;
+}
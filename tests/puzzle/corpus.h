@@ -0,0 +1,52 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file defines the binary corpus format for sliding puzzle boards.
+//
+// A corpus starts with a 12 byte header: the magic "BBQC", the board width,
+// the format version, two reserved bytes and the number of boards as a
+// little-endian 32-bit word. Each board is then stored as its tiles in
+// row-major order, packed at 4 bits per tile for boards of up to 16 tiles and
+// 5 bits otherwise from the least significant bit of the first byte, and one
+// more byte holding the length of its optimal solution or kUnknownLength.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <vector>
+
+constexpr int kMaxTiles = 25;
+constexpr uint8_t kUnknownLength = 0xff;
+
+struct CorpusBoard {
+  uint8_t tiles[kMaxTiles];
+  uint8_t length;
+};
+
+// Returns whether `in` starts with the magic of a binary corpus.
+bool IsBinaryCorpus(std::istream &in);
+
+bool WriteCorpus(FILE *out, int width, const std::vector<CorpusBoard> &boards);
+
+// Returns false if `in` is not a well-formed corpus of the given width.
+bool ReadCorpus(std::istream &in, int width, std::vector<CorpusBoard> *boards);
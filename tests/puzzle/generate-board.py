@@ -30,8 +30,16 @@ from sys import argv, stderr
 class Board:
     HEADER_TEMPLATE = ''' #pragma once
 
+#if SIZE != {width}
+#error "problem.h was generated for another width"
+#endif
+
 board_t g_board = {{
-  .board = {}
+#ifdef PACKED_BOARD
+  .tiles = {packed:#x}ULL
+#else
+  .board = {board}
+#endif
 }}; '''
 
     def __init__(self, width):
@@ -40,6 +48,30 @@ board_t g_board = {{
         self.inversions = 0
         self.width = width
 
+    def scramble(self, moves):
+        self.board = list(range(1, self.width * self.width)) + [0]
+        blank = len(self.board) - 1
+        prev = None
+        for _ in range(moves):
+            row, col = divmod(blank, self.width)
+            neighbors = []
+            if row > 0:
+                neighbors.append(blank - self.width)
+            if row < self.width - 1:
+                neighbors.append(blank + self.width)
+            if col > 0:
+                neighbors.append(blank - 1)
+            if col < self.width - 1:
+                neighbors.append(blank + 1)
+            if prev in neighbors and len(neighbors) > 1:
+                neighbors.remove(prev)
+            dst = random.choice(neighbors)
+            self.board[blank], self.board[dst] = self.board[dst], 0
+            prev, blank = blank, dst
+
+        self.inversions = self.__calc_inversions()
+        self.empty_row = blank // self.width
+
     def shuffle(self):
         random.shuffle(self.board)
         self.inversions = self.__calc_inversions()
@@ -78,13 +110,15 @@ board_t g_board = {{
 
         rows = [to_carray(row) for row in board2d]
         board_carray = to_carray(rows)
-        return self.HEADER_TEMPLATE.format(board_carray)
+        packed = sum(tile << (4 * i) for i, tile in enumerate(self.board))
+        return self.HEADER_TEMPLATE.format(width=width, packed=packed,
+                                           board=board_carray)
 
     def is_solvable(self):
         if self.width % 2 == 1:
             return (self.inversions % 2 == 0)
         else:
-            return ((self.inversions + self.width - self.empty_row) % 2 == 0)
+            return ((self.inversions + self.width - self.empty_row) % 2 == 1)
 
     def __calc_inversions(self):
         inversions = 0
@@ -103,25 +137,36 @@ def main():
     parser = argparse.ArgumentParser()
     parser.add_argument("--header", action="store_true", help="generate c header file")
     parser.add_argument("--verbose", action="store_true")
+    parser.add_argument("--scramble", type=int, metavar="MOVES", default=0,
+                        help="make random moves from the goal instead of shuffling")
+    parser.add_argument("--count", type=int, default=1,
+                        help="number of boards to print, one after another")
     parser.add_argument("width", type=int, help="board width")
     args = parser.parse_args()
 
     width = args.width
-    board = Board(width)
-    board.shuffle()
-
-    if args.verbose:
-        print('inversion count: {}'.format(board.inversions), file=stderr)
-        print('manhattan distance: {}'.format(board.manhattan_distance()), file=stderr)
-
-    if args.header:
-        print(board.get_header())
-    else:
-        for i in range(width):
-            start = i * width
-            end = (i + 1) * width
-            row = (str(i) for i in board.board[start:end])
-            print(' '.join(row))
+    if args.header and args.count != 1:
+        parser.error("--header takes a single board")
+
+    for _ in range(args.count):
+        board = Board(width)
+        if args.scramble > 0:
+            board.scramble(args.scramble)
+        else:
+            board.shuffle()
+
+        if args.verbose:
+            print('inversion count: {}'.format(board.inversions), file=stderr)
+            print('manhattan distance: {}'.format(board.manhattan_distance()), file=stderr)
+
+        if args.header:
+            print(board.get_header())
+        else:
+            for i in range(width):
+                start = i * width
+                end = (i + 1) * width
+                row = (str(i) for i in board.board[start:end])
+                print(' '.join(row))
 
 
 if __name__ == "__main__":
@@ -0,0 +1,349 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Generates reproducible corpora of random solvable boards of width SIZE.
+//
+// Boards are shuffled uniformly, or made by random moves from the goal with
+// -m. With -l, each board is labeled with the length of its optimal solution
+// by the native solver, and -r keeps only the boards whose optimal length
+// falls within a range, which stratifies a corpus by true difficulty.
+//
+// Usage: generate-corpus [-n count] [-s seed] [-m moves] [-l] [-r min:max]
+//                        [-j threads] [-f text|header|binary] > corpus
+//
+// The text format is the one printed by generate-board.py, with the label of
+// each board in a comment before it. The header format is problem.h and holds
+// a single board. The binary format is described in corpus.h.
+
+extern "C" {
+#include "puzzle.h"
+}
+
+#include <getopt.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "corpus.h"
+
+namespace {
+
+constexpr int kNumTiles = SIZE * SIZE;
+
+enum class Format { kText, kHeader, kBinary };
+
+// xoshiro256**, which unlike the distributions of <random> gives the same
+// sequence everywhere.
+class Rng {
+ public:
+  explicit Rng(uint64_t seed) {
+    for (auto &s : s_) {
+      seed += 0x9e3779b97f4a7c15;
+      uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      s = z ^ (z >> 31);
+    }
+  }
+
+  uint64_t Next() {
+    const uint64_t result = Rotl(s_[1] * 5, 7) * 9;
+    const uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = Rotl(s_[3], 45);
+    return result;
+  }
+
+  // Returns a number in [0, n).
+  uint32_t Below(uint32_t n) {
+    return (static_cast<uint64_t>(Next() >> 32) * n) >> 32;
+  }
+
+ private:
+  static uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  uint64_t s_[4];
+};
+
+// A board is solvable if and only if the parity of the permutation of its
+// cells matches the parity of the distance of the blank from its home.
+bool IsSolvable(const uint8_t *tiles) {
+  bool visited[kNumTiles] = {};
+  int parity = 0;
+  int blank = 0;
+  for (int i = 0; i < kNumTiles; i++) {
+    if (tiles[i] == 0) blank = i;
+    if (visited[i]) continue;
+    // A cycle of length k is made of k - 1 transpositions.
+    for (int j = i; !visited[j]; j = (tiles[j] + kNumTiles - 1) % kNumTiles) {
+      visited[j] = true;
+      parity ^= 1;
+    }
+    parity ^= 1;
+  }
+  const int distance = (SIZE - 1 - blank / SIZE) + (SIZE - 1 - blank % SIZE);
+  return parity == distance % 2;
+}
+
+void Shuffle(Rng *rng, uint8_t *tiles) {
+  for (int i = 0; i < kNumTiles; i++) tiles[i] = i;
+  for (int i = kNumTiles - 1; i > 0; i--) {
+    std::swap(tiles[i], tiles[rng->Below(i + 1)]);
+  }
+  if (IsSolvable(tiles)) return;
+
+  // Swapping two tiles flips the parity of the permutation.
+  const int a = tiles[0] == 0 ? 1 : 0;
+  const int b = tiles[kNumTiles - 1] == 0 ? kNumTiles - 2 : kNumTiles - 1;
+  std::swap(tiles[a], tiles[b]);
+}
+
+void Scramble(Rng *rng, int moves, uint8_t *tiles) {
+  for (int i = 0; i < kNumTiles; i++) tiles[i] = (i + 1) % kNumTiles;
+  int blank = kNumTiles - 1;
+  int prev = -1;
+  for (int m = 0; m < moves; m++) {
+    int neighbors[4];
+    int n = 0;
+    const int row = blank / SIZE;
+    const int col = blank % SIZE;
+    if (row > 0) neighbors[n++] = blank - SIZE;
+    if (row < SIZE - 1) neighbors[n++] = blank + SIZE;
+    if (col > 0) neighbors[n++] = blank - 1;
+    if (col < SIZE - 1) neighbors[n++] = blank + 1;
+
+    int dst;
+    do {
+      dst = neighbors[rng->Below(n)];
+    } while (dst == prev);
+    tiles[blank] = tiles[dst];
+    tiles[dst] = 0;
+    prev = blank;
+    blank = dst;
+  }
+}
+
+int OptimalLength(const uint8_t *tiles) {
+  board_t board = {};
+  for (int i = 0; i < kNumTiles; i++) {
+    set_tile(&board, i % SIZE, i / SIZE, tiles[i]);
+  }
+  init_board(&board);
+  if (board.is_goal) return 0;
+
+  mstack_t solution = {};
+  int max_cost = heuristic(&board);
+  while (max_cost < MAX_DEPTH) {
+    const int min_cost = solve(&board, max_cost, &solution);
+    if (min_cost == 0) return solution.len;
+    max_cost = min_cost;
+  }
+  return kUnknownLength;
+}
+
+void Label(int nthreads, std::vector<CorpusBoard> *boards) {
+  std::atomic<size_t> next(0);
+  auto work = [&] {
+    for (size_t i; (i = next++) < boards->size();) {
+      (*boards)[i].length = OptimalLength((*boards)[i].tiles);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 1; i < nthreads; i++) threads.emplace_back(work);
+  work();
+  for (auto &thread : threads) thread.join();
+}
+
+void AppendNumber(std::string *out, unsigned n) {
+  if (n >= 10) AppendNumber(out, n / 10);
+  *out += '0' + n % 10;
+}
+
+void WriteText(const std::vector<CorpusBoard> &boards) {
+  std::string out;
+  for (const CorpusBoard &board : boards) {
+    if (board.length != kUnknownLength) {
+      out += "# optimal ";
+      AppendNumber(&out, board.length);
+      out += '\n';
+    }
+    for (int i = 0; i < kNumTiles; i++) {
+      AppendNumber(&out, board.tiles[i]);
+      out += i % SIZE == SIZE - 1 ? '\n' : ' ';
+    }
+    if (out.size() > (1 << 16)) {
+      std::fwrite(out.data(), 1, out.size(), stdout);
+      out.clear();
+    }
+  }
+  std::fwrite(out.data(), 1, out.size(), stdout);
+}
+
+void WriteHeader(const CorpusBoard &board) {
+  uint64_t packed = 0;
+  std::string rows;
+  for (int i = 0; i < kNumTiles; i++) {
+    if (i < 16) packed |= static_cast<uint64_t>(board.tiles[i]) << (4 * i);
+    rows += i % SIZE == 0 ? "{ " : ",";
+    AppendNumber(&rows, board.tiles[i]);
+    if (i % SIZE == SIZE - 1) rows += i == kNumTiles - 1 ? " }" : " },";
+  }
+
+  std::printf(" #pragma once\n\n");
+  std::printf("#if SIZE != %d\n", SIZE);
+  std::printf("#error \"problem.h was generated for another width\"\n");
+  std::printf("#endif\n\n");
+  std::printf("board_t g_board = {\n");
+  std::printf("#ifdef PACKED_BOARD\n");
+  std::printf("  .tiles = %#llxULL\n", static_cast<unsigned long long>(packed));
+  std::printf("#else\n");
+  std::printf("  .board = { %s }\n", rows.c_str());
+  std::printf("#endif\n");
+  std::printf("}; \n");
+}
+
+void Usage(const char *argv0) {
+  std::fprintf(stderr,
+               "usage: %s [-n count] [-s seed] [-m moves] [-l] [-r min:max]\n"
+               "       [-j threads] [-f text|header|binary]\n",
+               argv0);
+  std::exit(EXIT_FAILURE);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = 1;
+  uint64_t seed = 1;
+  int moves = 0;
+  bool label = false;
+  int min_length = 0;
+  int max_length = MAX_DEPTH;
+  int nthreads = std::max(1u, std::thread::hardware_concurrency());
+  Format format = Format::kText;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:s:m:lr:j:f:")) != -1) {
+    switch (opt) {
+      case 'n':
+        count = std::strtoull(optarg, nullptr, 0);
+        break;
+      case 's':
+        seed = std::strtoull(optarg, nullptr, 0);
+        break;
+      case 'm':
+        moves = std::atoi(optarg);
+        break;
+      case 'l':
+        label = true;
+        break;
+      case 'r':
+        if (std::sscanf(optarg, "%d:%d", &min_length, &max_length) != 2) {
+          Usage(argv[0]);
+        }
+        label = true;
+        break;
+      case 'j':
+        nthreads = std::max(1, std::atoi(optarg));
+        break;
+      case 'f':
+        if (std::strcmp(optarg, "text") == 0) {
+          format = Format::kText;
+        } else if (std::strcmp(optarg, "header") == 0) {
+          format = Format::kHeader;
+        } else if (std::strcmp(optarg, "binary") == 0) {
+          format = Format::kBinary;
+        } else {
+          Usage(argv[0]);
+        }
+        break;
+      default:
+        Usage(argv[0]);
+    }
+  }
+  if (format == Format::kHeader && count != 1) {
+    std::fprintf(stderr, "generate-corpus: the header holds a single board\n");
+    return EXIT_FAILURE;
+  }
+  if (format == Format::kBinary && isatty(STDOUT_FILENO)) {
+    std::fprintf(stderr, "generate-corpus: refusing to write to a terminal\n");
+    return EXIT_FAILURE;
+  }
+
+  // Boards are generated in rounds and filtered in order, so the corpus only
+  // depends on the seed and not on the number of threads.
+  const bool filter = min_length > 0 || max_length < MAX_DEPTH;
+  Rng rng(seed);
+  std::vector<CorpusBoard> corpus;
+  while (corpus.size() < count) {
+    size_t size = std::min<size_t>(count - corpus.size(), 1 << 20);
+    if (filter) size = std::max<size_t>(size, 1 << 10);
+
+    std::vector<CorpusBoard> round(size);
+    for (CorpusBoard &board : round) {
+      if (moves > 0) {
+        Scramble(&rng, moves, board.tiles);
+      } else {
+        Shuffle(&rng, board.tiles);
+      }
+      board.length = kUnknownLength;
+    }
+    if (label) Label(nthreads, &round);
+
+    for (const CorpusBoard &board : round) {
+      if (filter && (board.length < min_length || board.length > max_length)) {
+        continue;
+      }
+      corpus.push_back(board);
+    }
+  }
+  corpus.resize(count);
+
+  switch (format) {
+    case Format::kText:
+      WriteText(corpus);
+      break;
+    case Format::kHeader:
+      WriteHeader(corpus[0]);
+      break;
+    case Format::kBinary:
+      if (!WriteCorpus(stdout, SIZE, corpus)) {
+        std::perror("generate-corpus");
+        return EXIT_FAILURE;
+      }
+      break;
+  }
+  return EXIT_SUCCESS;
+}
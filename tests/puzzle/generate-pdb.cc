@@ -0,0 +1,163 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Generates the additive pattern database for the sliding puzzle as C source.
+//
+// The tiles are split into disjoint groups. For each group, a breadth-first
+// search over the positions of its tiles and the blank finds the least number
+// of moves of those tiles needed to bring them home, while moves of the other
+// tiles are free. Every move moves a single tile, so the sum over all groups
+// never overestimates the true distance.
+//
+// Usage: generate-pdb <width> > pdb.c
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+namespace {
+
+constexpr uint8_t kUnreached = 0xff;
+
+std::vector<std::vector<int>> Groups(int width) {
+  switch (width) {
+    case 4:
+      // 4-4-4-3, with each group a 2x2 block of the goal
+      return {{1, 2, 5, 6}, {3, 4, 7, 8}, {9, 10, 13, 14}, {11, 12, 15}};
+    case 5:
+      // eight groups of three in row-major order
+      return {{1, 2, 3},    {4, 5, 6},    {7, 8, 9},    {10, 11, 12},
+              {13, 14, 15}, {16, 17, 18}, {19, 20, 21}, {22, 23, 24}};
+    default:
+      return {};
+  }
+}
+
+// Searches the state space of one group. A state is the position of the
+// blank in the lowest `bits` bits followed by the positions of the tiles of
+// the group. Returns the table indexed by the positions of the tiles alone.
+std::vector<uint8_t> Search(int width, int bits,
+                            const std::vector<int> &group) {
+  const int ncells = width * width;
+  const int k = group.size();
+  const uint32_t mask = (1u << bits) - 1;
+  std::vector<uint8_t> dist(1u << (bits * (k + 1)), kUnreached);
+  std::vector<uint8_t> table(1u << (bits * k), kUnreached);
+
+  uint32_t goal = ncells - 1;
+  for (int i = 0; i < k; i++) goal |= (group[i] - 1) << (bits * (i + 1));
+
+  // Moving the blank onto a tile of the group costs one move and onto any
+  // other tile none, so a deque keeps the search in order of distance.
+  std::deque<uint32_t> queue = {goal};
+  dist[goal] = 0;
+  while (!queue.empty()) {
+    const uint32_t state = queue.front();
+    queue.pop_front();
+
+    const int blank = state & mask;
+    const uint32_t tiles = state >> bits;
+    if (dist[state] < table[tiles]) table[tiles] = dist[state];
+
+    const int x = blank % width;
+    const int y = blank / width;
+    const int neighbors[4][2] = {
+        {x, y - 1}, {x, y + 1}, {x - 1, y}, {x + 1, y}};
+    for (const auto &n : neighbors) {
+      if (n[0] < 0 || n[0] >= width || n[1] < 0 || n[1] >= width) continue;
+      const int dst = n[1] * width + n[0];
+
+      uint32_t next = (state & ~mask) | dst;
+      int cost = 0;
+      for (int i = 0; i < k; i++) {
+        const int shamt = bits * (i + 1);
+        if (static_cast<int>((state >> shamt) & mask) == dst) {
+          next = (next & ~(mask << shamt)) | (blank << shamt);
+          cost = 1;
+        }
+      }
+
+      if (dist[next] <= dist[state] + cost) continue;
+      dist[next] = dist[state] + cost;
+      if (cost == 0) queue.push_front(next);
+      else queue.push_back(next);
+    }
+  }
+
+  return table;
+}
+
+void PrintArray(const char *decl, const std::vector<uint8_t> &values) {
+  std::printf("%s = {", decl);
+  for (size_t i = 0; i < values.size(); i++) {
+    std::printf("%s%u,", i % 16 == 0 ? "\n  " : " ", values[i]);
+  }
+  std::printf("\n};\n\n");
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  const int width = argc == 2 ? std::atoi(argv[1]) : 0;
+  const std::vector<std::vector<int>> groups = Groups(width);
+  if (groups.empty()) {
+    std::fprintf(stderr, "usage: %s <width>\n", argv[0]);
+    std::fprintf(stderr, "supported widths are 4 and 5\n");
+    return EXIT_FAILURE;
+  }
+
+  const int ncells = width * width;
+  const int bits = width <= 4 ? 4 : 5;
+  std::vector<uint8_t> group_of(ncells, 0);
+  std::vector<uint8_t> slot_of(ncells, 0);
+  for (size_t g = 0; g < groups.size(); g++) {
+    for (size_t i = 0; i < groups[g].size(); i++) {
+      group_of[groups[g][i]] = g;
+      slot_of[groups[g][i]] = i;
+    }
+  }
+
+  std::printf("// Generated by generate-pdb %d. Do not edit.\n\n", width);
+  std::printf("#include \"pdb.h\"\n\n");
+  std::printf("#if SIZE != %d\n", width);
+  std::printf("#error \"pattern database generated for another width\"\n");
+  std::printf("#endif\n\n");
+  std::printf("const int pdb_ngroups = %zu;\n\n", groups.size());
+  PrintArray("const uint8_t pdb_group_of[SIZE * SIZE]", group_of);
+  PrintArray("const uint8_t pdb_slot_of[SIZE * SIZE]", slot_of);
+
+  for (size_t g = 0; g < groups.size(); g++) {
+    char decl[64];
+    std::snprintf(decl, sizeof(decl), "static const uint8_t pdb_table%zu[]",
+                  g);
+    PrintArray(decl, Search(width, bits, groups[g]));
+  }
+
+  std::printf("const uint8_t* const pdb_tables[] = {");
+  for (size_t g = 0; g < groups.size(); g++) {
+    std::printf("%spdb_table%zu", g == 0 ? "" : ", ", g);
+  }
+  std::printf("};\n");
+
+  return EXIT_SUCCESS;
+}
@@ -25,57 +25,49 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "../region.h"
 #include "board.h"
 #include "puzzle.h"
 #include "utils.h"
 
-void print_moves(mstack_t* moves);
+#ifdef BBQ_SIMULATION
+#include "../firmware/firmware.h"
+#endif
 
-int main(void) {
-  load_board(&g_board);
+// Solves the board in g_board and prints the moves. Returns false if there is
+// no solution within MAX_DEPTH moves.
+static bool solve_board(void) {
   init_board(&g_board);
 
+  mstack_t answer = {.moves = {MOVE_INVALID}, .len = 0};
   if (g_board.is_goal) {
-    return EXIT_SUCCESS;
+    print_moves(&answer);
+    return true;
   }
 
-  mstack_t answer = {.moves = {MOVE_INVALID}, .len = 0};
   int max_cost = heuristic(&g_board);
   while (max_cost < MAX_DEPTH) {
+    BBQ_REGION_BEGIN(max_cost);
     int min_cost = solve(&g_board, max_cost, &answer);
+    BBQ_REGION_END(max_cost);
     if (min_cost == 0) {
       print_moves(&answer);
-      return EXIT_SUCCESS;
+      return true;
     }
     max_cost = min_cost;
   }
 
-  return EXIT_FAILURE;
+  return false;
 }
 
-void print_moves(mstack_t* moves) {
-  while (!stack_empty(moves)) {
-    move_t m = stack_pop(moves);
-
-    char direction;
-    switch (m) {
-      case MOVE_UP:
-        direction = 'U';
-        break;
-      case MOVE_DOWN:
-        direction = 'D';
-        break;
-      case MOVE_RIGHT:
-        direction = 'R';
-        break;
-      case MOVE_LEFT:
-        direction = 'L';
-        break;
-      default:
-        direction = '?';
-    }
-
-    putchar(direction);
+int main(void) {
+  int status = EXIT_SUCCESS;
+  while (load_board(&g_board)) {
+    if (!solve_board()) status = EXIT_FAILURE;
   }
-  putchar('\n');
+
+#ifdef BBQ_SIMULATION
+  stats();
+#endif
+  return status;
 }
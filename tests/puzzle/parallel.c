@@ -0,0 +1,142 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file implements a parallel variant of the sliding puzzle solver for the
+// multi-hart configuration. Every IDA* iteration is split into one job per
+// pair of leading moves, and the harts pick jobs from a shared counter.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../firmware/firmware.h"
+#include "../region.h"
+#include "board.h"
+#include "puzzle.h"
+
+#ifndef NHARTS
+#define NHARTS 1
+#endif
+
+#define NMOVES (MOVE_SIZE - MOVE_FIRST)
+#define NJOBS (NMOVES * NMOVES)
+
+void hart_main(int hartid);
+
+static int g_round;
+static int g_max_cost;
+static int g_next_job;
+static int g_min_cost;
+static int g_solved_job;
+static int g_done;
+static mstack_t g_answers[NJOBS];
+
+// Waits without touching memory so that spinning harts leave the shared data
+// memory port to the harts doing useful work.
+static inline void cpu_relax(void) {
+  for (int i = 0; i < 64; i++) {
+    asm volatile("");
+  }
+}
+
+static void update_min_cost(int cost) {
+  int curr = __atomic_load_n(&g_min_cost, __ATOMIC_RELAXED);
+  while (cost < curr &&
+         !__atomic_compare_exchange_n(&g_min_cost, &curr, cost, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+static void run_jobs(void) {
+  int max_cost = g_max_cost;
+
+  while (__atomic_load_n(&g_solved_job, __ATOMIC_RELAXED) < 0) {
+    int job = __atomic_fetch_add(&g_next_job, 1, __ATOMIC_RELAXED);
+    if (job >= NJOBS) {
+      break;
+    }
+
+    move_t first = MOVE_FIRST + job / NMOVES;
+    move_t second = MOVE_FIRST + job % NMOVES;
+    int cost =
+        solve_subtree(&g_board, first, second, max_cost, &g_answers[job]);
+    if (cost == 0) {
+      __atomic_exchange_n(&g_solved_job, job, __ATOMIC_RELAXED);
+    } else {
+      update_min_cost(cost);
+    }
+  }
+
+  __atomic_fetch_add(&g_done, 1, __ATOMIC_RELEASE);
+}
+
+void hart_main(int hartid) {
+  (void)hartid;
+
+  int seen = 0;
+  for (;;) {
+    int round;
+    while ((round = __atomic_load_n(&g_round, __ATOMIC_ACQUIRE)) == seen) {
+      cpu_relax();
+    }
+    seen = round;
+    run_jobs();
+  }
+}
+
+int main(void) {
+  load_board(&g_board);
+  init_board(&g_board);
+
+  if (g_board.is_goal) {
+    return EXIT_SUCCESS;
+  }
+
+  int round = 0;
+  int max_cost = heuristic(&g_board);
+  while (max_cost < MAX_DEPTH) {
+    g_max_cost = max_cost;
+    g_next_job = 0;
+    g_min_cost = INF;
+    g_solved_job = -1;
+    g_done = 0;
+    for (int i = 0; i < NJOBS; i++) {
+      g_answers[i].len = 0;
+    }
+
+    BBQ_REGION_BEGIN(max_cost);
+    __atomic_store_n(&g_round, ++round, __ATOMIC_RELEASE);
+    run_jobs();
+    while (__atomic_load_n(&g_done, __ATOMIC_ACQUIRE) < NHARTS) {
+      cpu_relax();
+    }
+    BBQ_REGION_END(max_cost);
+
+    if (g_solved_job >= 0) {
+      print_moves(&g_answers[g_solved_job]);
+      stats();
+      return EXIT_SUCCESS;
+    }
+    max_cost = g_min_cost;
+  }
+
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,48 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file declares the additive pattern database used as the heuristic for
+// boards of width 4 and 5. The tables are generated by generate-pdb.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "puzzle.h"
+
+// Bits per tile position in a table index
+#if SIZE <= 4
+#define PDB_BITS 4
+#else
+#define PDB_BITS 5
+#endif
+
+#define PDB_MAX_GROUPS 8
+
+extern const int pdb_ngroups;
+
+// The group of every tile and its slot within the group, indexed by tile
+extern const uint8_t pdb_group_of[SIZE * SIZE];
+extern const uint8_t pdb_slot_of[SIZE * SIZE];
+
+// The least number of moves of the tiles of a group needed to bring them home,
+// indexed by their positions
+extern const uint8_t* const pdb_tables[];
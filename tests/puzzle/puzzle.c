@@ -23,14 +23,26 @@
 
 #include "puzzle.h"
 
-#include <limits.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "../runtime.h"
+#include "accel.h"
+#include "simd.h"
 #include "utils.h"
 
-#define INF (INT_MAX / 2)
+#if SIZE >= 4
+#include "pdb.h"
+#endif
+
+#ifdef COUNT_NODES
+__thread uint64_t g_nodes;
+#define COUNT_NODE() (g_nodes++)
+#else
+#define COUNT_NODE()
+#endif
 
 // Private Functions
 
@@ -40,6 +52,23 @@ static inline bool is_illegal(int empty_x, int empty_y) {
   return !(x_ok && y_ok);
 }
 
+// Returns the move that undoes `move`. The search never tries it right after
+// `move`, since it would only lead back to a board already visited.
+static inline move_t reverse_move(move_t move) {
+  switch (move) {
+    case MOVE_UP:
+      return MOVE_DOWN;
+    case MOVE_DOWN:
+      return MOVE_UP;
+    case MOVE_RIGHT:
+      return MOVE_LEFT;
+    case MOVE_LEFT:
+      return MOVE_RIGHT;
+    default:
+      return MOVE_INVALID;
+  }
+}
+
 static inline int total_cost(const board_t* board) {
   return board->depth + board->estimated_cost;
 }
@@ -75,14 +104,19 @@ static bool apply_move(board_t* board, move_t move) {
     return false;
   }
 
-  int swap_val = board->board[dst_y][dst_x];
-  board->board[y][x] = swap_val;
-  board->board[dst_y][dst_x] = 0;
+#ifdef HAVE_PUZZLE_UNIT
+  board->tiles = pz_move(board->tiles, dst_y * SIZE + dst_x, y * SIZE + x);
+#else
+  int swap_val = get_tile(board, dst_x, dst_y);
+  set_tile(board, x, y, swap_val);
+  set_tile(board, dst_x, dst_y, 0);
+#endif
   board->empty_tile[0] = dst_x;
   board->empty_tile[1] = dst_y;
 
   board->estimated_cost = heuristic(board);
   board->depth += 1;
+  COUNT_NODE();
 
   if (board->estimated_cost == 0) {
     board->is_goal = true;
@@ -110,6 +144,10 @@ static int search_moves(const board_t* board, move_t move, int max_cost,
     return curr_cost;
   } else {
     for (move_t m = MOVE_FIRST; m < MOVE_SIZE; m++) {
+      if (m == reverse_move(move)) {
+        continue;
+      }
+
       int cost = search_moves(&curr_board, m, max_cost, solution);
       if (cost == 0) {
         found = true;
@@ -134,6 +172,16 @@ static int search_moves(const board_t* board, move_t move, int max_cost,
 // Search
 
 void init_board(board_t* board) {
+  // The blank is found first, since the heuristic may use its position.
+  for (int i = 0; i < SIZE; i++) {
+    for (int j = 0; j < SIZE; j++) {
+      if (get_tile(board, j, i) == 0) {
+        board->empty_tile[0] = j;
+        board->empty_tile[1] = i;
+      }
+    }
+  }
+
   board->depth = 0;
   board->estimated_cost = heuristic(board);
   if (board->estimated_cost == 0) {
@@ -141,30 +189,109 @@ void init_board(board_t* board) {
   } else {
     board->is_goal = false;
   }
+}
+
+#if SIZE >= 4
+
+// Sums the pattern database entries of every group of tiles. The index into
+// the table of a group is made of the positions of its tiles, PDB_BITS bits
+// each.
+int heuristic(const board_t* board) {
+  uint32_t index[PDB_MAX_GROUPS] = {0};
 
   for (int i = 0; i < SIZE; i++) {
     for (int j = 0; j < SIZE; j++) {
-      if (board->board[i][j] == 0) {
-        board->empty_tile[0] = j;
-        board->empty_tile[1] = i;
-        return;
+      int val = get_tile(board, j, i);
+      if (val == 0) {
+        continue;
       }
+
+      uint32_t pos = i * SIZE + j;
+      index[pdb_group_of[val]] |= pos << (PDB_BITS * pdb_slot_of[val]);
     }
   }
+
+  int cost = 0;
+  for (int g = 0; g < pdb_ngroups; g++) {
+    cost += pdb_tables[g][index[g]];
+  }
+  return cost;
+}
+
+#elif defined(HAVE_PUZZLE_UNIT)
+
+int heuristic(const board_t* board) {
+  return pz_dist(board->tiles);
+}
+
+#elif defined(HAVE_PACKED_SIMD)
+
+// The packed board is widened from four bits to a byte per square, four
+// squares per word, and the goal column and row of every tile are computed
+// with packed comparisons, so that pbsad sums the distances of four tiles at
+// once. The blank and the squares past the board count as tile SIZE * SIZE,
+// whose goal is the last square, and the distance of the blank is taken off
+// at the end. Only 3x3 boards get here, since larger ones use the pattern
+// database.
+#define SIMD_WORDS ((SIZE * SIZE + 3) / 4)
+#define BYTES(b) ((uint32_t)(b) * 0x01010101u)
+#define SQUARE_COL(p) ((p) < SIZE * SIZE ? (p) % SIZE : SIZE - 1)
+#define SQUARE_ROW(p) ((p) < SIZE * SIZE ? (p) / SIZE : SIZE - 1)
+#define SQUARE_WORD(f, w)                                         \
+  ((uint32_t)f(4 * (w)) | (uint32_t)f(4 * (w) + 1) << 8 |         \
+   (uint32_t)f(4 * (w) + 2) << 16 | (uint32_t)f(4 * (w) + 3) << 24)
+
+static const uint32_t square_cols[SIMD_WORDS] = {
+    SQUARE_WORD(SQUARE_COL, 0), SQUARE_WORD(SQUARE_COL, 1),
+    SQUARE_WORD(SQUARE_COL, 2)};
+static const uint32_t square_rows[SIMD_WORDS] = {
+    SQUARE_WORD(SQUARE_ROW, 0), SQUARE_WORD(SQUARE_ROW, 1),
+    SQUARE_WORD(SQUARE_ROW, 2)};
+
+// Spreads the four nibbles of the low halfword of `x` over its four bytes.
+static inline uint32_t nibbles_to_bytes(uint32_t x) {
+  x = ((x & 0xff00) << 8) | (x & 0xff);
+  return ((x & 0x00f000f0) << 4) | (x & 0x000f000f);
+}
+
+// Returns the distance of the tiles on squares 4 * w to 4 * w + 3, whose
+// nibbles are the low halfword of `tiles`.
+static inline uint32_t simd_distance(uint32_t tiles, int w) {
+  // Tiles 1 to 8 become 0 to 7, and the blank 8.
+  uint32_t goal = p_umin8(p_sub8(nibbles_to_bytes(tiles), BYTES(1)), BYTES(8));
+
+  // Each comparison is 0xff, or -1, from the first tile of its row on.
+  uint32_t row = p_sub8(p_sub8(0, p_ucmplt8(BYTES(2), goal)),
+                        p_ucmplt8(BYTES(5), goal));
+  uint32_t col = p_sub8(p_sub8(p_sub8(goal, row), row), row);
+
+  return p_pbsad(col, square_cols[w]) + p_pbsad(row, square_rows[w]);
 }
 
+int heuristic(const board_t* board) {
+  uint32_t lo = board->tiles;
+  uint32_t hi = board->tiles >> 32;
+  int manhattan = simd_distance(lo, 0) + simd_distance(lo >> 16, 1) +
+                  simd_distance(hi, 2);
+
+  return manhattan - (2 * (SIZE - 1) - board->empty_tile[0] -
+                      board->empty_tile[1]);
+}
+
+#else  // SIZE >= 4
+
 int heuristic(const board_t* board) {
   int manhattan = 0;
 
   for (int i = 0; i < SIZE; i++) {
     for (int j = 0; j < SIZE; j++) {
-      int val = board->board[i][j];
+      int val = get_tile(board, j, i);
       if (val == 0) {
         continue;
       }
 
-      int dest_x = (val - 1) % SIZE;
-      int dest_y = (val - 1) / SIZE;
+      int dest_x = modu_const(val - 1, SIZE);
+      int dest_y = divu_const(val - 1, SIZE);
       manhattan += abs(dest_x - j) + abs(dest_y - i);
     }
   }
@@ -172,6 +299,39 @@ int heuristic(const board_t* board) {
   return manhattan;
 }
 
+#endif  // SIZE >= 4
+
+int solve_subtree(const board_t* board, move_t first, move_t second,
+                  int max_cost, mstack_t* solution) {
+  board_t curr_board;
+  memcpy(&curr_board, board, sizeof(curr_board));
+
+  if (!apply_move(&curr_board, first)) {
+    return INF;
+  }
+
+  if (!curr_board.is_goal) {
+    int curr_cost = total_cost(&curr_board);
+    if (curr_cost > max_cost) {
+      return curr_cost;
+    }
+    if (second == reverse_move(first)) {
+      return INF;
+    }
+
+    int cost = search_moves(&curr_board, second, max_cost, solution);
+    if (cost != 0) {
+      return cost;
+    }
+  }
+
+  if (!stack_push(solution, first)) {
+    return INF;
+  }
+
+  return 0;
+}
+
 int solve(const board_t* board, int max_cost, mstack_t* solution) {
   int min_cost = INF;
 
@@ -187,3 +347,32 @@ int solve(const board_t* board, int max_cost, mstack_t* solution) {
 
   return min_cost;
 }
+
+// Output
+
+void print_moves(mstack_t* moves) {
+  while (!stack_empty(moves)) {
+    move_t m = stack_pop(moves);
+
+    char direction;
+    switch (m) {
+      case MOVE_UP:
+        direction = 'U';
+        break;
+      case MOVE_DOWN:
+        direction = 'D';
+        break;
+      case MOVE_RIGHT:
+        direction = 'R';
+        break;
+      case MOVE_LEFT:
+        direction = 'L';
+        break;
+      default:
+        direction = '?';
+    }
+
+    putchar(direction);
+  }
+  putchar('\n');
+}
@@ -23,18 +23,47 @@
 
 #pragma once
 
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
+// The board width is set by the build.
+#ifndef SIZE
 #define SIZE 3
+#endif
+
+// MAX_DEPTH bounds the length of optimal solutions: 31 moves for 3x3 and 80
+// for 4x4 boards. The bound for 5x5 boards is not known; 208 is a safe upper
+// limit.
+#if SIZE == 3
 #define MAX_DEPTH 32
+#elif SIZE == 4
+#define MAX_DEPTH 81
+#elif SIZE == 5
+#define MAX_DEPTH 208
+#else
+#error "unsupported board size"
+#endif
+
+#define INF (INT_MAX / 2)
+
+// Boards of up to 16 tiles are packed into 64 bits, four bits per tile, which
+// keeps the copies made on every move of the search small.
+#if SIZE <= 4
+#define PACKED_BOARD
+#endif
 
 typedef struct {
   bool is_goal;
   int depth;
   int estimated_cost;
   int empty_tile[2];
+#ifdef PACKED_BOARD
+  uint64_t tiles;
+#else
   int board[SIZE][SIZE];
+#endif
 } board_t;
 
 typedef enum {
@@ -61,8 +90,49 @@ void init_board(board_t* board);
 int heuristic(const board_t* board);
 int solve(const board_t* board, int max_cost, mstack_t* solution);
 
+// Searches only the subtree reached by making `first` and then `second`. This
+// splits an IDA* iteration into independent jobs.
+int solve_subtree(const board_t* board, move_t first, move_t second,
+                  int max_cost, mstack_t* solution);
+
+// Output
+
+void print_moves(mstack_t* moves);
+
+// Statistics
+
+#ifdef COUNT_NODES
+// Number of boards expanded by the calling thread.
+extern __thread uint64_t g_nodes;
+#endif
+
 // Stack manipulation
 
+#ifdef PACKED_BOARD
+
+static inline int get_tile(const board_t* board, int x, int y) {
+  return (board->tiles >> (4 * (y * SIZE + x))) & 0xf;
+}
+
+static inline void set_tile(board_t* board, int x, int y, int val) {
+  int shamt = 4 * (y * SIZE + x);
+  board->tiles &= ~((uint64_t)0xf << shamt);
+  board->tiles |= (uint64_t)val << shamt;
+}
+
+#else  // PACKED_BOARD
+
+static inline int get_tile(const board_t* board, int x, int y) {
+  return board->board[y][x];
+}
+
+static inline void set_tile(board_t* board, int x, int y, int val) {
+  board->board[y][x] = val;
+}
+
+#endif  // PACKED_BOARD
+
+
 static inline bool stack_empty(const mstack_t* stack) {
   return stack->len == 0;
 }
@@ -0,0 +1,66 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file defines intrinsics for the packed-SIMD instructions of the core.
+// See src/alu.v for the instructions. They are only available with BBQ_SIMD
+// on boards of up to 16 tiles.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "puzzle.h"
+
+#if defined(BBQ_SIMD) && defined(PACKED_BOARD)
+
+#define HAVE_PACKED_SIMD
+
+// Returns the bytes of `a` minus those of `b`, modulo 256.
+static inline uint32_t p_sub8(uint32_t a, uint32_t b) {
+  uint32_t diff;
+  asm(".insn r 0x77, 0, 0x25, %0, %1, %2" : "=r"(diff) : "r"(a), "r"(b));
+  return diff;
+}
+
+// Returns 0xff in every byte where the unsigned byte of `a` is less than that
+// of `b`, and 0 elsewhere.
+static inline uint32_t p_ucmplt8(uint32_t a, uint32_t b) {
+  uint32_t lt;
+  asm(".insn r 0x77, 0, 0x17, %0, %1, %2" : "=r"(lt) : "r"(a), "r"(b));
+  return lt;
+}
+
+// Returns the smaller unsigned byte of `a` and `b` in every byte.
+static inline uint32_t p_umin8(uint32_t a, uint32_t b) {
+  uint32_t min;
+  asm(".insn r 0x77, 0, 0x4c, %0, %1, %2" : "=r"(min) : "r"(a), "r"(b));
+  return min;
+}
+
+// Returns the sum of the absolute differences of the four unsigned bytes of
+// `a` and `b`.
+static inline uint32_t p_pbsad(uint32_t a, uint32_t b) {
+  uint32_t sad;
+  asm(".insn r 0x77, 0, 0x7e, %0, %1, %2" : "=r"(sad) : "r"(a), "r"(b));
+  return sad;
+}
+
+#endif  // defined(BBQ_SIMD) && defined(PACKED_BOARD)
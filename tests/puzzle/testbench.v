@@ -22,7 +22,10 @@
 
 `timescale 1ns / 1ps
 
-module testbench ();
+module testbench #(
+  parameter UNIFIED_MEM = 0,
+  parameter DMA         = 0
+)();
 
   `include "constants.vh"
 
@@ -39,9 +42,11 @@ module testbench ();
 
   simulation #(
     .PC_START(`D_XLEN'h1000),
-    .STACK_ADDR(`D_XLEN'h1000),
-    .IMEM_NWORDS(1 << 16),
-    .DMEM_NWORDS(1 << 16)
+    .STACK_ADDR(`D_XLEN'hffff0),
+    .IMEM_NWORDS(1 << 18),
+    .DMEM_NWORDS(1 << 18),
+    .UNIFIED_MEM(UNIFIED_MEM),
+    .DMA(DMA)
   ) simulation (
     .clk(clk),
     .reset(reset)
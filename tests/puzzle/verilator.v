@@ -20,21 +20,51 @@
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
-module verilator (
+module verilator #(
+  parameter ENABLE_COUNTERS = 1,
+  parameter FUSION          = 1,
+  parameter LOGGERS         = 0,
+  parameter PROF_PERIOD     = 0,
+  parameter SPARSE_MEM      = 0,
+  parameter UNIFIED_MEM     = 0,
+  parameter TCM_STACK       = 0,
+  parameter DMEM_WAIT       = 0,
+  parameter DMA             = 0,
+  parameter IMEM_NWORDS     = (1 << 18),
+  parameter DMEM_NWORDS     = (1 << 18)
+)(
   input clk,
-  input reset
+  input reset,
+
+  output idle
 );
 
   `include "constants.vh"
 
+  // With TCM_STACK the stack grows down from the top of the scratchpad
+  // instead of the data memory.
+  localparam TCM_NWORDS = 2048;
+  localparam STACK_ADDR = TCM_STACK ? `D_XLEN'h0400_0000 + TCM_NWORDS * 4 - 16
+                                    : `D_XLEN'hffff0;
+
   simulation #(
+    .ENABLE_COUNTERS(ENABLE_COUNTERS),
+    .FUSION(FUSION),
+    .LOGGERS(LOGGERS),
+    .PROF_PERIOD(PROF_PERIOD),
     .PC_START(`D_XLEN'h1000),
-    .STACK_ADDR(`D_XLEN'h1000),
-    .IMEM_NWORDS(1 << 16),
-    .DMEM_NWORDS(1 << 16)
+    .STACK_ADDR(STACK_ADDR),
+    .IMEM_NWORDS(IMEM_NWORDS),
+    .DMEM_NWORDS(DMEM_NWORDS),
+    .SPARSE_MEM(SPARSE_MEM),
+    .UNIFIED_MEM(UNIFIED_MEM),
+    .TCM_NWORDS(TCM_NWORDS),
+    .DMEM_WAIT(DMEM_WAIT),
+    .DMA(DMA)
   ) simulation (
     .clk(clk),
-    .reset(reset)
+    .reset(reset),
+    .idle(idle)
   );
 
 endmodule
@@ -0,0 +1,57 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+module verilator #(
+  parameter NHARTS          = 4,
+  parameter ENABLE_COUNTERS = 1,
+  parameter FUSION          = 1,
+  parameter PROF_PERIOD     = 0,
+  parameter SPARSE_MEM      = 0,
+  parameter UNIFIED_MEM     = 0
+)(
+  input clk,
+  input reset,
+
+  output idle
+);
+
+  `include "constants.vh"
+
+  simulation_mp #(
+    .NHARTS(NHARTS),
+    .ENABLE_COUNTERS(ENABLE_COUNTERS),
+    .FUSION(FUSION),
+    .PROF_PERIOD(PROF_PERIOD),
+    .PC_START(`D_XLEN'h1000),
+    .STACK_ADDR(`D_XLEN'hffff0),
+    .STACK_SIZE(`D_XLEN'h4000),
+    .IMEM_NWORDS(1 << 18),
+    .DMEM_NWORDS(1 << 18),
+    .SPARSE_MEM(SPARSE_MEM),
+    .UNIFIED_MEM(UNIFIED_MEM)
+  ) simulation (
+    .clk(clk),
+    .reset(reset),
+    .idle(idle)
+  );
+
+endmodule
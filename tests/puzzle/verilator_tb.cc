@@ -20,14 +20,50 @@
 // OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 // Testbench for the puzzle program using verilator
+//
+// Pass +elf=<path> to load the program into the sparse memory, which designs
+// built with SPARSE_MEM use instead of the hex files. When the design is built
+// with a nonzero PROF_PERIOD, the samples of the profiler are drained while the
+// simulation runs and a flat profile, symbolized with the same ELF, is printed
+// at the end. The timing regions marked by the program are printed at the end
+// as well, and written as JSON to the file given with +regions=<path>.
+//
+// The console input of the core reads from the file given with +input=<path>,
+// or from the standard input with +input=-.
+//
+// Designs built with LOGGERS log the life of every instruction in the Kanata
+// format of the Konata pipeline viewer to the file given with +pipeview=<path>,
+// and a trace of the retired instructions for whatif to the file given
+// with +trace=<path>.
+//
+// While every hart sleeps in wfi, the simulation skips ahead to the next timer
+// event instead of clocking through the idle cycles. It stops if nothing is
+// left to wake the harts.
+//
+// The simulation speed in clocked cycles per second of wall time is printed at
+// the end, to track how fast the model runs.
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
 #include <memory>
+#include <string>
 
 #include <verilated.h>
 
 #include "Vverilator.h"
+#include "idle.h"
+#include "pipeview.h"
+#include "profile.h"
+#include "regions.h"
+#include "sparse_memory.h"
+#include "trace.h"
 
 static constexpr int kStartupWaitTime = 3 * 2;  // 3 clocks
+static constexpr int kDrainInterval = 64 * 2;   // 64 clocks
+static constexpr char kProfilerScope[] =
+    "TOP.verilator.simulation.bbq.sysbus.profiler";
 static vluint64_t main_time = 0;
 
 double sc_time_stamp() { return main_time; }
@@ -35,6 +71,33 @@ double sc_time_stamp() { return main_time; }
 int main(int argc, char *argv[]) {
   Verilated::commandArgs(argc, argv);
 
+  std::string elf = Verilated::commandArgsPlusMatch("elf=");
+  if (!elf.empty()) {
+    elf = elf.substr(sizeof("+elf=") - 1);
+    if (!SparseMemory::Instance().LoadElf(elf)) {
+      std::cerr << "failed to load " << elf << std::endl;
+      return 1;
+    }
+  }
+
+  std::string pipeview = Verilated::commandArgsPlusMatch("pipeview=");
+  if (!pipeview.empty()) {
+    pipeview = pipeview.substr(sizeof("+pipeview=") - 1);
+    if (!PipeView::Instance().Open(pipeview)) {
+      std::cerr << "failed to open " << pipeview << std::endl;
+      return 1;
+    }
+  }
+
+  std::string trace = Verilated::commandArgsPlusMatch("trace=");
+  if (!trace.empty()) {
+    trace = trace.substr(sizeof("+trace=") - 1);
+    if (!TraceWriter::Instance().Open(trace)) {
+      std::cerr << "failed to open " << trace << std::endl;
+      return 1;
+    }
+  }
+
   auto tb = std::make_unique<Vverilator>();
   tb->clk = 0;
   tb->reset = 1;
@@ -47,13 +110,54 @@ int main(int argc, char *argv[]) {
 
   tb->reset = 0;
 
+  Profile profile(kProfilerScope);
+  const auto start = std::chrono::steady_clock::now();
+
   while (!Verilated::gotFinish()) {
     tb->eval();
+    if (!tb->clk && tb->idle) {
+      const uint64_t cycles = Idle::Instance().FastForward();
+      if (cycles == 0) {
+        std::cerr << "every hart waits for an interrupt that never comes"
+                  << std::endl;
+        break;
+      }
+      main_time += 2 * cycles;
+      tb->eval();
+    }
     tb->clk = !tb->clk;
     main_time++;
+    if (main_time % kDrainInterval == 0) profile.Drain();
   }
 
   tb->final();
 
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const uint64_t clocked = main_time / 2 - Idle::Instance().skipped();
+  char speed[128];
+  std::snprintf(speed, sizeof(speed), "speed: %.0f cycles/s over %.2f s\n",
+                clocked / elapsed.count(), elapsed.count());
+  std::cerr << speed;
+
+  profile.Drain();
+  if (profile.samples() > 0) profile.Report(elf, std::cerr);
+
+  if (Idle::Instance().skipped() > 0) {
+    std::cerr << "idle: " << Idle::Instance().skipped() << " cycles skipped"
+              << std::endl;
+  }
+
+  const Regions &regions = Regions::Instance();
+  if (!regions.empty()) {
+    regions.Report(std::cerr);
+
+    std::string json = Verilated::commandArgsPlusMatch("regions=");
+    if (!json.empty()) {
+      std::ofstream out(json.substr(sizeof("+regions=") - 1));
+      regions.WriteJson(out);
+    }
+  }
+
   return 0;
 }
@@ -0,0 +1,45 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file defines markers for timing regions of a program on the core.
+//
+// BBQ_REGION_BEGIN(id) and BBQ_REGION_END(id) are single writes to the custom
+// mregion CSR. The Verilator testbenches count the cycles, instructions and
+// calls of every region and report them when the simulation ends, so the
+// program needs no code to read or print the counters. Ids range from 0 to
+// 2^31 - 1, and regions with different ids may overlap. The markers compile to
+// nothing on other targets.
+
+#pragma once
+
+#ifdef __riscv
+
+#define BBQ_REGION_MARK(value) \
+  asm volatile("csrw 0x7c1, %0" : : "r"(value) : "memory")
+#define BBQ_REGION_BEGIN(id) BBQ_REGION_MARK(((unsigned int)(id) << 1) | 1)
+#define BBQ_REGION_END(id) BBQ_REGION_MARK((unsigned int)(id) << 1)
+
+#else  // __riscv
+
+#define BBQ_REGION_BEGIN(id) ((void)(id))
+#define BBQ_REGION_END(id) ((void)(id))
+
+#endif  // __riscv
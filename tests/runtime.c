@@ -0,0 +1,152 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file implements the memory routines of the C library for the core.
+// Aligned buffers are handled a word at a time, eight words per iteration,
+// instead of the byte loops of the generic versions. It must be built with
+// -fno-tree-loop-distribute-patterns so that the loops are not turned back
+// into calls to memcpy and memset.
+//
+// With BBQ_DMA, large aligned buffers in the data memory are handed to the DMA
+// engine instead, which moves a word every one or two cycles and pays the wait
+// states of the data memory once per burst. Shorter ones stay on the core,
+// where programming the engine would cost more than it saves.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef BBQ_DMA
+#include "dma.h"
+
+// The sizes from which the engine wins, measured on the instruction set
+// simulator with the timing of src/dma.v for every multiple of 32 bytes up to
+// 128 and for 256. They fall as the data memory gets slower, since the core
+// waits on every word and the engine once per burst. A fill on the core makes
+// one access per word rather than two, so it holds out longer.
+#ifndef BBQ_DMEM_WAIT
+#define BBQ_DMEM_WAIT 0
+#endif
+
+#if BBQ_DMEM_WAIT == 0
+#define BBQ_DMA_COPY_MIN 256
+#define BBQ_DMA_FILL_MIN 256
+#elif BBQ_DMEM_WAIT == 1
+#define BBQ_DMA_COPY_MIN 40
+#define BBQ_DMA_FILL_MIN 96
+#elif BBQ_DMEM_WAIT == 2
+#define BBQ_DMA_COPY_MIN 40
+#define BBQ_DMA_FILL_MIN 40
+#else
+#define BBQ_DMA_COPY_MIN 32
+#define BBQ_DMA_FILL_MIN 40
+#endif
+#endif
+
+void* memcpy(void* dst, const void* src, size_t len) {
+  uint8_t* d = dst;
+  const uint8_t* s = src;
+
+  if ((((uintptr_t)dst | (uintptr_t)src) & 3) == 0) {
+    uint32_t* dw = dst;
+    const uint32_t* sw = src;
+#ifdef BBQ_DMA
+    if (len >= BBQ_DMA_COPY_MIN && bbq_dma_reaches(dst, len) &&
+        bbq_dma_reaches(src, len)) {
+      size_t n = len & ~(size_t)3;
+      bbq_dma_copy(dw, sw, n);
+      dw += n / 4;
+      sw += n / 4;
+      len -= n;
+    }
+#endif
+    for (; len >= 32; len -= 32) {
+      uint32_t w0 = sw[0];
+      uint32_t w1 = sw[1];
+      uint32_t w2 = sw[2];
+      uint32_t w3 = sw[3];
+      uint32_t w4 = sw[4];
+      uint32_t w5 = sw[5];
+      uint32_t w6 = sw[6];
+      uint32_t w7 = sw[7];
+      dw[0] = w0;
+      dw[1] = w1;
+      dw[2] = w2;
+      dw[3] = w3;
+      dw[4] = w4;
+      dw[5] = w5;
+      dw[6] = w6;
+      dw[7] = w7;
+      dw += 8;
+      sw += 8;
+    }
+    for (; len >= 4; len -= 4) {
+      *dw++ = *sw++;
+    }
+    d = (uint8_t*)dw;
+    s = (const uint8_t*)sw;
+  }
+
+  while (len--) {
+    *d++ = *s++;
+  }
+  return dst;
+}
+
+void* memset(void* dst, int c, size_t len) {
+  uint8_t* d = dst;
+
+  if (((uintptr_t)dst & 3) == 0) {
+    uint32_t w = (uint8_t)c;
+    w |= w << 8;
+    w |= w << 16;
+
+    uint32_t* dw = dst;
+#ifdef BBQ_DMA
+    if (len >= BBQ_DMA_FILL_MIN && bbq_dma_reaches(dst, len)) {
+      size_t n = len & ~(size_t)3;
+      bbq_dma_fill(dw, w, n);
+      dw += n / 4;
+      len -= n;
+    }
+#endif
+    for (; len >= 32; len -= 32) {
+      dw[0] = w;
+      dw[1] = w;
+      dw[2] = w;
+      dw[3] = w;
+      dw[4] = w;
+      dw[5] = w;
+      dw[6] = w;
+      dw[7] = w;
+      dw += 8;
+    }
+    for (; len >= 4; len -= 4) {
+      *dw++ = w;
+    }
+    d = (uint8_t*)dw;
+  }
+
+  while (len--) {
+    *d++ = (uint8_t)c;
+  }
+  return dst;
+}
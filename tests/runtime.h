@@ -0,0 +1,97 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file defines division by small constants for the core.
+//
+// RV32I has no divide instruction, so `/` and `%` become calls to libgcc's
+// __udivsi3 and __umodsi3, which run a shift-subtract loop of 32 iterations or
+// more. Here the quotient is estimated by multiplying with the reciprocal of
+// the divisor built from shifts and adds, and then corrected from the
+// remainder (Hacker's Delight, 10-17). Builds without BBQ_RUNTIME, such as the
+// native ones, use `/` instead.
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef BBQ_RUNTIME
+
+static inline uint32_t divu3(uint32_t n) {
+  uint32_t q = (n >> 2) + (n >> 4);
+  q += q >> 4;
+  q += q >> 8;
+  q += q >> 16;
+  uint32_t r = n - ((q << 1) + q);
+  return q + (((r << 2) + r + 5) >> 4);
+}
+
+static inline uint32_t divu5(uint32_t n) {
+  uint32_t q = (n >> 3) + (n >> 4);
+  q += q >> 4;
+  q += q >> 8;
+  q += q >> 16;
+  uint32_t r = n - ((q << 2) + q);
+  return q + (((r << 3) + (r << 2) + r) >> 6);
+}
+
+static inline uint32_t divu10(uint32_t n) {
+  uint32_t q = (n >> 1) + (n >> 2);
+  q += q >> 4;
+  q += q >> 8;
+  q += q >> 16;
+  q >>= 3;
+  uint32_t r = n - (((q << 2) + q) << 1);
+  return q + (r > 9);
+}
+
+// Divides by `d`, which should be a constant so that the switch folds away.
+static inline uint32_t divu_const(uint32_t n, uint32_t d) {
+  switch (d) {
+    case 1:
+      return n;
+    case 2:
+      return n >> 1;
+    case 3:
+      return divu3(n);
+    case 4:
+      return n >> 2;
+    case 5:
+      return divu5(n);
+    case 10:
+      return divu10(n);
+    case 100:
+      return divu10(divu10(n));
+    default:
+      return n / d;
+  }
+}
+
+#else  // BBQ_RUNTIME
+
+static inline uint32_t divu_const(uint32_t n, uint32_t d) {
+  return n / d;
+}
+
+#endif  // BBQ_RUNTIME
+
+static inline uint32_t modu_const(uint32_t n, uint32_t d) {
+  return n - divu_const(n, d) * d;
+}
@@ -0,0 +1,67 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Top module of the sampled simulation. The testbench places the program and
+// a stub restoring the architectural state in the sparse memory, and the core
+// starts at the stub. The retired instruction count is exposed so that the
+// testbench can tell where the measured windows begin and end, and whether
+// fusion is enabled so that it can count the cycles of the stub.
+module sample #(
+  parameter FUSION          = 1
+) (
+  input clk,
+  input reset,
+
+  output test_passed,
+  output error,
+  output [63:0] instret,
+  output fusion
+);
+
+  `include "constants.vh"
+
+  bbq #(
+    .PC_START(`D_XLEN'hf000_0000),
+    .STACK_ADDR(`D_XLEN'hffff0),
+    .SPARSE_MEM(1),
+    .FUSION(FUSION)
+  ) bbq (
+    // input
+    .clk(clk),
+    .reset(reset),
+    .console_rx_valid(1'b0),
+    .console_rx_data(8'b0),
+    .console_rx_eof(1'b1),
+
+    // output
+    .console_we(),
+    .console_wdata(),
+    .console_rx_ready(),
+    .test_passed(test_passed),
+    .idle(),
+    .error(error)
+  );
+
+  assign instret = bbq.datapath.csr.instret;
+  assign fusion = FUSION != 0;
+
+endmodule
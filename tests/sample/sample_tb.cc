@@ -0,0 +1,272 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Sampled simulation of barbecue
+//
+// Runs the program given with +elf on the instruction set simulator while
+// collecting its basic block vectors, clusters the intervals, and simulates
+// only a few intervals per cluster on the core. Each of them starts from the
+// state the simulator reached, which is restored by a stub that the core runs
+// before jumping into the program. The CPI of the whole program is estimated
+// from the measured intervals together with a 95% confidence interval.
+//
+//   +elf=<path>          program to run
+//   +interval=<n>        instructions per interval
+//   +clusters=<n>        maximum number of clusters
+//   +per_cluster=<n>     intervals to simulate per cluster
+//   +warmup=<n>          instructions to run on the core before measuring
+//   +seed=<n>            random seed
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <verilated.h>
+
+#include "Vsample.h"
+#include "iss.h"
+#include "simpoint.h"
+#include "sparse_memory.h"
+
+namespace {
+
+constexpr int kStartupWaitTime = 3;  // clocks
+constexpr uint32_t kProgramStart = 0x1000;  // as in the puzzle testbenches
+constexpr uint32_t kStubBase = 0xf0000000;
+constexpr uint32_t kStackAddr = 0xffff0;
+constexpr uint64_t kMaxCpi = 100;
+
+constexpr int kCsrMstatus = 0x300;
+constexpr int kCsrMie = 0x304;
+constexpr int kCsrMtvec = 0x305;
+constexpr int kCsrMscratch = 0x340;
+constexpr int kCsrMepc = 0x341;
+constexpr int kCsrMcause = 0x342;
+constexpr int kCsrMtval = 0x343;
+constexpr int kCsrMprof = 0x7c0;
+constexpr int kCsrCycle = 0xc00;
+constexpr int kCsrInstret = 0xc02;
+constexpr int kCsrCycleh = 0xc80;
+constexpr int kCsrInstreth = 0xc82;
+
+std::unique_ptr<Vsample> top;
+double main_time = 0;
+
+std::string PlusArg(const char *name, const std::string &fallback) {
+  const std::string prefix = std::string(name) + "=";
+  const std::string match = Verilated::commandArgsPlusMatch(prefix.c_str());
+  if (match.empty()) return fallback;
+  return match.substr(prefix.size() + 1);
+}
+
+void Tick() {
+  top->clk = 1;
+  top->eval();
+  main_time++;
+  top->clk = 0;
+  top->eval();
+  main_time++;
+}
+
+// Emits the code of the restore stub.
+class Stub {
+ public:
+  // Loads `value` into `rd` in exactly two instructions.
+  void LoadImmediate(int rd, uint32_t value) {
+    const uint32_t upper = (value + 0x800) & 0xfffff000;
+    const uint32_t lower = (value - upper) & 0xfff;
+    words_.push_back(upper | rd << 7 | 0x37);                      // lui
+    words_.push_back(lower << 20 | rd << 15 | rd << 7 | 0x13);     // addi
+  }
+
+  // Writes `value` to `csr` through x1 in three instructions.
+  void WriteCsr(int csr, uint32_t value) {
+    LoadImmediate(1, value);
+    words_.push_back(csr << 20 | 1 << 15 | 1 << 12 | 0x73);  // csrrw x0
+  }
+
+  void Mret() { words_.push_back(0x30200073); }
+
+  const std::vector<uint32_t> &words() const { return words_; }
+
+ private:
+  std::vector<uint32_t> words_;
+};
+
+// Builds the stub that moves the core to the state of `iss` and jumps to its
+// pc with mret. The counters are written last and account for the
+// instructions of the stub that still retire after them. With `fusion`, each
+// lui/addi pair takes a single cycle. The timer, the console and the MPIE bit
+// of mstatus are not restored.
+std::vector<uint32_t> RestoreStub(const Iss &iss, bool fusion) {
+  const Iss::Csrs &csrs = iss.csrs();
+  const int load_cycles = fusion ? 1 : 2;
+  const int instret_tail = 2 * 31 + 1;  // register loads and mret
+  const int cycle_tail = 31 * load_cycles + 1 + 2 * (load_cycles + 1);
+  const uint64_t instret = csrs.instret - instret_tail;
+  const uint64_t cycle = csrs.cycle - cycle_tail;
+
+  Stub stub;
+  stub.WriteCsr(kCsrMtvec, csrs.mtvec);
+  stub.WriteCsr(kCsrMscratch, csrs.mscratch);
+  stub.WriteCsr(kCsrMcause, csrs.mcause);
+  stub.WriteCsr(kCsrMtval, csrs.mtval);
+  stub.WriteCsr(kCsrMie, csrs.mie);
+  stub.WriteCsr(kCsrMprof, csrs.mprof);
+  stub.WriteCsr(kCsrMepc, iss.pc());
+  stub.WriteCsr(kCsrMstatus, ((csrs.mstatus >> 3) & 1) << 7);  // MIE to MPIE
+  stub.WriteCsr(kCsrCycleh, cycle >> 32);
+  stub.WriteCsr(kCsrCycle, cycle);
+  stub.WriteCsr(kCsrInstreth, instret >> 32);
+  stub.WriteCsr(kCsrInstret, instret);
+  for (int i = 1; i < 32; i++) stub.LoadImmediate(i, iss.reg(i));
+  stub.Mret();
+  return stub.words();
+}
+
+// Measures the CPI of the core from the state of `iss`, running `warmup`
+// instructions before the `length` that are measured. Returns a negative
+// value if the core stops before the measurement begins.
+double Measure(const Iss &iss, const SparseMemory &memory, uint64_t warmup,
+               uint64_t length) {
+  SparseMemory &core_memory = SparseMemory::Instance();
+  core_memory.CopyFrom(memory);
+  const std::vector<uint32_t> stub = RestoreStub(iss, top->fusion);
+  for (size_t i = 0; i < stub.size(); i++) {
+    core_memory.Write(kStubBase + i * 4, stub[i], ~0u);
+  }
+
+  top->reset = 1;
+  for (int i = 0; i < kStartupWaitTime; i++) Tick();
+  top->reset = 0;
+
+  const uint64_t begin = iss.csrs().instret + warmup;
+  const uint64_t end = begin + length;
+  const uint64_t max_cycles = kMaxCpi * (warmup + length) + 2 * stub.size();
+  uint64_t cycles = 0;
+  while (top->instret < begin && !top->error && cycles < max_cycles) {
+    Tick();
+    cycles++;
+  }
+  if (top->instret < begin) return -1;
+
+  const uint64_t start_cycles = cycles;
+  const uint64_t start_instret = top->instret;
+  while (top->instret < end && !top->error && cycles < max_cycles) {
+    Tick();
+    cycles++;
+  }
+  if (top->instret == start_instret) return -1;
+  return static_cast<double>(cycles - start_cycles) /
+         (top->instret - start_instret);
+}
+
+}  // namespace
+
+double sc_time_stamp() { return main_time; }
+
+int main(int argc, char *argv[]) {
+  Verilated::commandArgs(argc, argv);
+
+  const std::string elf = PlusArg("elf", "");
+  const uint64_t interval = std::stoull(PlusArg("interval", "100000"));
+  const int max_clusters = std::stoi(PlusArg("clusters", "8"));
+  const int per_cluster = std::stoi(PlusArg("per_cluster", "2"));
+  const uint64_t warmup = std::stoull(PlusArg("warmup", "1000"));
+  const uint64_t seed = std::stoull(PlusArg("seed", "1"));
+
+  SparseMemory program;
+  if (elf.empty() || !program.LoadElf(elf)) {
+    std::fprintf(stderr, "sample: failed to load %s\n", elf.c_str());
+    return 1;
+  }
+
+  // Profile the whole program on the simulator.
+  SparseMemory memory;
+  memory.CopyFrom(program);
+  Iss profiler(&memory);
+  profiler.set_pc(kProgramStart);
+  profiler.set_reg(2, kStackAddr);
+  BbvCollector bbv(interval, seed);
+  const Iss::Status status =
+      profiler.Run(UINT64_MAX, [&bbv](const Retired &r) { bbv.Add(r); });
+  bbv.Finish();
+  std::fputs(profiler.console().c_str(), stdout);
+  if (!profiler.test_passed()) {
+    std::fprintf(stderr, "sample: the program did not pass (status %d)\n",
+                 static_cast<int>(status));
+  }
+
+  std::mt19937_64 rng(seed);
+  const SamplePlan plan = PlanSamples(bbv, max_clusters, per_cluster, &rng);
+  std::vector<int> samples;
+  for (const SamplePlan::Cluster &cluster : plan.clusters) {
+    samples.insert(samples.end(), cluster.samples.begin(),
+                   cluster.samples.end());
+  }
+  std::sort(samples.begin(), samples.end());
+
+  // Fast-forward to every sample in order and measure it on the core.
+  top.reset(new Vsample());
+  top->clk = 0;
+  top->eval();
+  memory.CopyFrom(program);
+  Iss iss(&memory);
+  iss.set_pc(kProgramStart);
+  iss.set_reg(2, kStackAddr);
+  std::unordered_map<int, double> cpi;
+  uint64_t detailed = 0;
+  for (int sample : samples) {
+    const uint64_t start = sample * interval;
+    const uint64_t skip = std::min(warmup, start);
+    if (iss.Run(start - skip) != Iss::Status::kRunning) break;
+
+    const uint64_t length = bbv.lengths()[sample];
+    const double measured = Measure(iss, memory, skip, length);
+    if (measured < 0) {
+      std::fprintf(stderr, "sample: interval %d did not run on the core\n",
+                   sample);
+      continue;
+    }
+    cpi[sample] = measured;
+    detailed += skip + length;
+  }
+  top->final();
+  top.reset();
+
+  uint64_t total = 0;
+  for (uint64_t length : bbv.lengths()) total += length;
+  const Estimate estimate = EstimateCpi(plan, bbv, cpi);
+
+  std::printf("sample: %" PRIu64 " instructions, %zu intervals of %" PRIu64
+              ", %zu clusters\n",
+              total, bbv.lengths().size(), interval, plan.clusters.size());
+  std::printf("sample: %zu intervals measured, %.2f%% simulated in detail\n",
+              cpi.size(), 100.0 * detailed / std::max<uint64_t>(total, 1));
+  std::printf("sample: estimated CPI %.4f +/- %.4f (95%%)\n", estimate.cpi,
+              estimate.bound);
+  return cpi.empty() ? 1 : 0;
+}
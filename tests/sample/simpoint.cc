@@ -0,0 +1,223 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "simpoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int kMaxIterations = 100;
+constexpr double kZ95 = 1.96;
+
+double Distance(const BbvCollector::Vector &a, const BbvCollector::Vector &b) {
+  double sum = 0;
+  for (int d = 0; d < BbvCollector::kDims; d++) {
+    sum += (a[d] - b[d]) * (a[d] - b[d]);
+  }
+  return sum;
+}
+
+int Nearest(const BbvCollector::Vector &v,
+            const std::vector<BbvCollector::Vector> &centroids) {
+  int best = 0;
+  double best_distance = std::numeric_limits<double>::max();
+  for (size_t c = 0; c < centroids.size(); c++) {
+    const double distance = Distance(v, centroids[c]);
+    if (distance < best_distance) {
+      best = c;
+      best_distance = distance;
+    }
+  }
+  return best;
+}
+
+// Picks `k` initial centroids with the k-means++ seeding.
+std::vector<BbvCollector::Vector> Seed(
+    const std::vector<BbvCollector::Vector> &vectors, int k,
+    std::mt19937_64 *rng) {
+  std::vector<BbvCollector::Vector> centroids;
+  std::uniform_int_distribution<size_t> first(0, vectors.size() - 1);
+  centroids.push_back(vectors[first(*rng)]);
+
+  std::vector<double> weights(vectors.size());
+  while (static_cast<int>(centroids.size()) < k) {
+    for (size_t i = 0; i < vectors.size(); i++) {
+      const int nearest = Nearest(vectors[i], centroids);
+      weights[i] = Distance(vectors[i], centroids[nearest]);
+    }
+    if (*std::max_element(weights.begin(), weights.end()) == 0) break;
+    std::discrete_distribution<size_t> next(weights.begin(), weights.end());
+    centroids.push_back(vectors[next(*rng)]);
+  }
+  return centroids;
+}
+
+}  // namespace
+
+constexpr int BbvCollector::kDims;
+
+void BbvCollector::Add(const Retired &retired) {
+  if (block_length_ == 0) block_start_ = retired.pc;
+  block_length_++;
+  current_length_++;
+
+  switch (retired.inst & 0x7f) {
+    case 0x63:  // branches
+    case 0x6f:  // jal
+    case 0x67:  // jalr
+    case 0x73:  // system
+      CloseBlock();
+      break;
+    default:
+      break;
+  }
+  if (current_length_ == interval_) Finish();
+}
+
+void BbvCollector::Finish() {
+  CloseBlock();
+  if (current_length_ == 0) return;
+
+  for (double &x : current_) x /= current_length_;
+  vectors_.push_back(current_);
+  lengths_.push_back(current_length_);
+  current_ = {};
+  current_length_ = 0;
+}
+
+const BbvCollector::Vector &BbvCollector::Projection(uint32_t pc) {
+  auto it = projections_.find(pc);
+  if (it != projections_.end()) return it->second;
+
+  std::mt19937_64 rng(seed_ ^ (pc * 0x9e3779b97f4a7c15ull));
+  std::uniform_real_distribution<double> uniform(-1, 1);
+  Vector &projection = projections_[pc];
+  for (double &x : projection) x = uniform(rng);
+  return projection;
+}
+
+void BbvCollector::CloseBlock() {
+  if (block_length_ == 0) return;
+  const Vector &projection = Projection(block_start_);
+  for (int d = 0; d < kDims; d++) current_[d] += block_length_ * projection[d];
+  block_length_ = 0;
+}
+
+SamplePlan PlanSamples(const BbvCollector &bbv, int max_clusters,
+                       int per_cluster, std::mt19937_64 *rng) {
+  const std::vector<BbvCollector::Vector> &vectors = bbv.vectors();
+  SamplePlan plan;
+  if (vectors.empty()) return plan;
+
+  const int k = std::min<int>(max_clusters, vectors.size());
+  std::vector<BbvCollector::Vector> centroids = Seed(vectors, k, rng);
+  std::vector<int> assignment(vectors.size(), -1);
+
+  for (int iteration = 0; iteration < kMaxIterations; iteration++) {
+    bool changed = false;
+    for (size_t i = 0; i < vectors.size(); i++) {
+      const int c = Nearest(vectors[i], centroids);
+      if (c != assignment[i]) {
+        assignment[i] = c;
+        changed = true;
+      }
+    }
+    if (!changed) break;
+
+    std::vector<BbvCollector::Vector> sums(centroids.size());
+    std::vector<int> counts(centroids.size());
+    for (size_t i = 0; i < vectors.size(); i++) {
+      for (int d = 0; d < BbvCollector::kDims; d++) {
+        sums[assignment[i]][d] += vectors[i][d];
+      }
+      counts[assignment[i]]++;
+    }
+    for (size_t c = 0; c < centroids.size(); c++) {
+      if (counts[c] == 0) continue;
+      for (int d = 0; d < BbvCollector::kDims; d++) {
+        centroids[c][d] = sums[c][d] / counts[c];
+      }
+    }
+  }
+
+  std::vector<SamplePlan::Cluster> clusters(centroids.size());
+  for (size_t i = 0; i < vectors.size(); i++) {
+    clusters[assignment[i]].members.push_back(i);
+    clusters[assignment[i]].instructions += bbv.lengths()[i];
+  }
+
+  for (size_t c = 0; c < clusters.size(); c++) {
+    SamplePlan::Cluster &cluster = clusters[c];
+    if (cluster.members.empty()) continue;
+
+    std::vector<int> others = cluster.members;
+    auto closest = std::min_element(
+        others.begin(), others.end(), [&](int a, int b) {
+          return Distance(vectors[a], centroids[c]) <
+                 Distance(vectors[b], centroids[c]);
+        });
+    cluster.samples.push_back(*closest);
+    others.erase(closest);
+
+    std::shuffle(others.begin(), others.end(), *rng);
+    const size_t extras = std::max(per_cluster - 1, 0);
+    others.resize(std::min(others.size(), extras));
+    cluster.samples.insert(cluster.samples.end(), others.begin(), others.end());
+    plan.clusters.push_back(std::move(cluster));
+  }
+  return plan;
+}
+
+Estimate EstimateCpi(const SamplePlan &plan, const BbvCollector &bbv,
+                     const std::unordered_map<int, double> &cpi) {
+  uint64_t total = 0;
+  for (uint64_t length : bbv.lengths()) total += length;
+
+  Estimate estimate;
+  double variance = 0;
+  for (const SamplePlan::Cluster &cluster : plan.clusters) {
+    std::vector<double> measured;
+    for (int sample : cluster.samples) {
+      auto it = cpi.find(sample);
+      if (it != cpi.end()) measured.push_back(it->second);
+    }
+    if (measured.empty()) continue;
+
+    const double weight = static_cast<double>(cluster.instructions) / total;
+    const double m = measured.size();
+    const double n = cluster.members.size();
+    double mean = 0;
+    for (double x : measured) mean += x / m;
+    estimate.cpi += weight * mean;
+
+    // A single sample says nothing about the spread of its cluster, and
+    // contributes no variance.
+    if (measured.size() < 2) continue;
+    double s2 = 0;
+    for (double x : measured) s2 += (x - mean) * (x - mean) / (m - 1);
+    variance += weight * weight * s2 / m * (1 - m / n);
+  }
+  estimate.bound = kZ95 * std::sqrt(variance);
+  return estimate;
+}
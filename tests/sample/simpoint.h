@@ -0,0 +1,102 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// SimPoint-style selection of representative intervals
+
+#ifndef BBQ_TESTS_SAMPLE_SIMPOINT_H_
+#define BBQ_TESTS_SAMPLE_SIMPOINT_H_
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "iss.h"
+
+// The basic block vectors of a program, randomly projected to a few
+// dimensions as they are collected. The program is cut into intervals of a
+// fixed number of instructions. A basic block ends at a branch or a jump and
+// is keyed by the address it starts at.
+class BbvCollector {
+ public:
+  static constexpr int kDims = 15;
+  using Vector = std::array<double, kDims>;
+
+  BbvCollector(uint64_t interval, uint64_t seed)
+      : interval_(interval), seed_(seed) {}
+
+  // Feeds the next retired instruction of the program.
+  void Add(const Retired &retired);
+
+  // Closes the last interval, which may be shorter than the others.
+  void Finish();
+
+  uint64_t interval() const { return interval_; }
+  const std::vector<Vector> &vectors() const { return vectors_; }
+  const std::vector<uint64_t> &lengths() const { return lengths_; }
+
+ private:
+  const Vector &Projection(uint32_t pc);
+  void CloseBlock();
+
+  uint64_t interval_;
+  uint64_t seed_;
+  std::unordered_map<uint32_t, Vector> projections_;
+
+  // The block and the interval being collected
+  uint32_t block_start_ = 0;
+  uint64_t block_length_ = 0;
+  Vector current_ = {};
+  uint64_t current_length_ = 0;
+
+  std::vector<Vector> vectors_;
+  std::vector<uint64_t> lengths_;
+};
+
+// The intervals to simulate in detail. Every cluster of similar intervals
+// contributes the interval closest to its centroid and up to `per_cluster - 1`
+// others picked at random, so that the spread within the cluster can be
+// estimated.
+struct SamplePlan {
+  struct Cluster {
+    uint64_t instructions = 0;  // in all of its intervals
+    std::vector<int> members;
+    std::vector<int> samples;
+  };
+
+  std::vector<Cluster> clusters;
+};
+
+SamplePlan PlanSamples(const BbvCollector &bbv, int max_clusters,
+                       int per_cluster, std::mt19937_64 *rng);
+
+// A stratified estimate of the CPI of the whole program from the CPI measured
+// for the sampled intervals, weighting every cluster by its instructions.
+struct Estimate {
+  double cpi = 0;
+  double bound = 0;  // half-width of the 95% confidence interval
+};
+
+Estimate EstimateCpi(const SamplePlan &plan, const BbvCollector &bbv,
+                     const std::unordered_map<int, double> &cpi);
+
+#endif  // BBQ_TESTS_SAMPLE_SIMPOINT_H_
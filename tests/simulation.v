@@ -23,13 +23,24 @@
 `timescale 1ns / 1ps
 
 module simulation #(
-  parameter PC_START    = `D_XLEN'h0,
-  parameter STACK_ADDR  = ~(`D_XLEN'h0),
-  parameter IMEM_NWORDS = (1 << 14),
-  parameter DMEM_NWORDS = (1 << 14)
+  parameter ENABLE_COUNTERS = 1,
+  parameter FUSION          = 1,
+  parameter LOGGERS         = 1,
+  parameter PROF_PERIOD     = 0,
+  parameter PC_START        = `D_XLEN'h0,
+  parameter STACK_ADDR      = ~(`D_XLEN'h0),
+  parameter IMEM_NWORDS     = (1 << 14),
+  parameter DMEM_NWORDS     = (1 << 14),
+  parameter SPARSE_MEM      = 0,
+  parameter UNIFIED_MEM     = 0,
+  parameter TCM_NWORDS      = 2048,
+  parameter DMEM_WAIT       = 0,
+  parameter DMA             = 0
 )(
   input clk,
-  input reset
+  input reset,
+
+  output idle
 );
 
   `include "constants.vh"
@@ -42,22 +53,39 @@ module simulation #(
   wire test_passed;
   wire console_we;
   wire [XLEN-1:0] console_wdata;
+  reg console_rx_valid = 1'b0;
+  reg [7:0] console_rx_data = 8'b0;
+  reg console_rx_eof = 1'b0;
+  wire console_rx_ready;
   reg enable_logger = 1'b0;
 
   bbq #(
+    .ENABLE_COUNTERS(ENABLE_COUNTERS),
+    .FUSION(FUSION),
+    .PROF_PERIOD(PROF_PERIOD),
     .PC_START(PC_START),
     .STACK_ADDR(STACK_ADDR),
     .IMEM_NWORDS(IMEM_NWORDS),
-    .DMEM_NWORDS(DMEM_NWORDS)
+    .DMEM_NWORDS(DMEM_NWORDS),
+    .SPARSE_MEM(SPARSE_MEM),
+    .UNIFIED_MEM(UNIFIED_MEM),
+    .TCM_NWORDS(TCM_NWORDS),
+    .DMEM_WAIT(DMEM_WAIT),
+    .DMA(DMA)
   ) bbq (
     // input
     .clk(clk),
     .reset(reset),
+    .console_rx_valid(console_rx_valid),
+    .console_rx_data(console_rx_data),
+    .console_rx_eof(console_rx_eof),
 
     // output
     .console_we(console_we),
     .console_wdata(console_wdata),
+    .console_rx_ready(console_rx_ready),
     .test_passed(test_passed),
+    .idle(idle),
     .error(error)
   );
 
@@ -69,6 +97,33 @@ module simulation #(
     end
   end
 
+  // With +input=<path>, the bytes of the file, or of the standard input if the
+  // path is "-", are offered to the console receiver one at a time, and the
+  // input ends with the file. Without it the input is empty.
+  reg [8*256-1:0] input_path;
+  integer input_fd = 0;
+  integer input_char;
+
+  initial begin
+    if ($value$plusargs("input=%s", input_path)) begin
+      if (input_path == "-") input_fd = $fopen("/dev/stdin", "r");
+      else input_fd = $fopen(input_path, "r");
+      if (input_fd == 0) begin
+        $display("failed to open the console input");
+        $fatal;
+      end
+    end
+  end
+
+  always @(posedge clk) begin
+    if (~reset && ~console_rx_eof && (~console_rx_valid || console_rx_ready)) begin
+      input_char = (input_fd != 0) ? $fgetc(input_fd) : -1;
+      console_rx_valid <= (input_char >= 0);
+      console_rx_data <= input_char[7:0];
+      console_rx_eof <= (input_char < 0);
+    end
+  end
+
   wire sim_fail    = ~reset && error && ~test_passed;
   wire sim_success = ~reset && error && test_passed;
 
@@ -98,75 +153,107 @@ module simulation #(
     end
   end
 
-  top_logger top_logger (
-    // input
-    .clk(clk),
-    .en(enable_logger),
-    .reset(reset),
-    .error(error)
-  );
-
-  pc_logger pc_logger (
-    // input
-    .clk(clk),
-    .en(enable_logger),
-    .pc(bbq.datapath.pc),
-    .sel(bbq.datapath.pc_mux.sel),
-    .next_base(bbq.datapath.pc_mux.base),
-    .next_offset(bbq.datapath.pc_mux.offset),
-    .branch(bbq.datapath.pc_mux.branch)
-  );
-
-  inst_logger inst_logger (
-    // input
-    .clk(clk),
-    .en(enable_logger),
-    .inst(bbq.datapath.inst)
-  );
-
-  alu_logger alu_logger (
-    // input
-    .clk(clk),
-    .en(enable_logger),
-    .opcode(bbq.datapath.alu.op),
-    .srca_sel(bbq.datapath.alu_src_mux.srca_sel),
-    .srcb_sel(bbq.datapath.alu_src_mux.srcb_sel),
-    .srca(bbq.datapath.alu.srca),
-    .srcb(bbq.datapath.alu.srcb),
-    .out(bbq.datapath.alu.out)
-  );
-
-  regfile_logger regfile_logger (
-    // input
-    .clk(clk),
-    .en(enable_logger),
-    .ra1(bbq.datapath.regfile.ra1),
-    .ra2(bbq.datapath.regfile.ra2),
-    .wa(bbq.datapath.regfile.wa),
-    .we(bbq.datapath.regfile.we),
-    .rd1(bbq.datapath.regfile.rd1),
-    .rd2(bbq.datapath.regfile.rd2),
-    .wdata(bbq.datapath.regfile.wdata)
-  );
-
-  imem_logger imem_logger (
-    // input
-    .clk(clk),
-    .en(enable_logger),
-    .addr(bbq.imem.addr),
-    .rdata(bbq.imem.rdata)
-  );
-
-  dmem_logger dmem_logger (
-    // input
-    .clk(clk),
-    .en(enable_logger),
-    .we(bbq.dmem.we),
-    .addr(bbq.dmem.addr),
-    .rdata(bbq.dmem.rdata),
-    .wdata(bbq.dmem.wdata),
-    .wmask(bbq.dmem.wmask)
-  );
+  // The loggers read deep into the core every cycle. With LOGGERS unset they
+  // are left out of the design altogether, which speeds up Verilator builds.
+  generate
+  if (LOGGERS) begin : loggers
+    top_logger top_logger (
+      // input
+      .clk(clk),
+      .en(enable_logger),
+      .reset(reset),
+      .error(error)
+    );
+
+    pc_logger pc_logger (
+      // input
+      .clk(clk),
+      .en(enable_logger),
+      .pc(bbq.datapath.pc),
+      .sel(bbq.datapath.pc_mux.sel),
+      .next_base(bbq.datapath.pc_mux.base),
+      .next_offset(bbq.datapath.pc_mux.offset),
+      .branch(bbq.datapath.pc_mux.branch)
+    );
+
+    inst_logger inst_logger (
+      // input
+      .clk(clk),
+      .en(enable_logger),
+      .inst(bbq.datapath.inst)
+    );
+
+    alu_logger alu_logger (
+      // input
+      .clk(clk),
+      .en(enable_logger),
+      .opcode(bbq.datapath.alu.op),
+      .srca_sel(bbq.datapath.alu_src_mux.srca_sel),
+      .srcb_sel(bbq.datapath.alu_src_mux.srcb_sel),
+      .srca(bbq.datapath.alu.srca),
+      .srcb(bbq.datapath.alu.srcb),
+      .out(bbq.datapath.alu.out)
+    );
+
+    regfile_logger regfile_logger (
+      // input
+      .clk(clk),
+      .en(enable_logger),
+      .ra1(bbq.datapath.regfile.ra1),
+      .ra2(bbq.datapath.regfile.ra2),
+      .wa(bbq.datapath.regfile.wa),
+      .we(bbq.datapath.regfile.we),
+      .rd1(bbq.datapath.regfile.rd1),
+      .rd2(bbq.datapath.regfile.rd2),
+      .wdata(bbq.datapath.regfile.wdata)
+    );
+
+    imem_logger imem_logger (
+      // input
+      .clk(clk),
+      .en(enable_logger),
+      .addr(bbq.imem_addr),
+      .rdata(bbq.imem_rdata)
+    );
+
+    dmem_logger dmem_logger (
+      // input
+      .clk(clk),
+      .en(enable_logger),
+      .we(bbq.dmem_we),
+      .addr(bbq.dmem_addr),
+      .rdata(bbq.dmem_rdata),
+      .wdata(bbq.dmem_wdata),
+      .wmask(bbq.dmem_wmask)
+    );
+
+    pipe_logger pipe_logger (
+      // input
+      .clk(clk),
+      .reset(reset),
+      .pc(bbq.datapath.pc),
+      .inst(bbq.datapath.fetched),
+      .fused(bbq.datapath.fused),
+      .next_inst(bbq.imem_next_rdata),
+      .pipe_event(bbq.datapath.pipe_event),
+      .cause(bbq.datapath.cause)
+    );
+
+    trace_logger trace_logger (
+      // input
+      .clk(clk),
+      .reset(reset),
+      .pc(bbq.datapath.pc),
+      .inst(bbq.datapath.fetched),
+      .fused(bbq.datapath.fused),
+      .next_inst(bbq.imem_next_rdata),
+      .next_pc(bbq.datapath.pc_next),
+      .dmem_addr(bbq.datapath.dmem_addr),
+      .dmem_access(bbq.datapath.dmem_re | bbq.datapath.dmem_we),
+      .pipe_event(bbq.datapath.pipe_event)
+    );
+  end
+  endgenerate
 
 endmodule // module simulation
 
@@ -268,8 +355,17 @@ module inst_logger (
       end
       RV_OP_IMM: inst_str = {arith_str, "i"};
       RV_OP: inst_str = arith_str;
+      RV_OP_P: inst_str = "simd";
       RV_SYSTEM: begin
         case (funct3)
+          RV_FUNCT3_PRIV: begin
+            case (inst[31:20])
+              RV_FUNCT12_ECALL:  inst_str = "ecall";
+              RV_FUNCT12_EBREAK: inst_str = "ebreak";
+              RV_FUNCT12_MRET:   inst_str = "mret";
+              default:           inst_str = "ERR";
+            endcase
+          end
           RV_FUNCT3_CSRRW:  inst_str = "csrrw";
           RV_FUNCT3_CSRRS:  inst_str = "csrrs";
           RV_FUNCT3_CSRRC:  inst_str = "csrrc";
@@ -279,6 +375,8 @@ module inst_logger (
           default:          inst_str = "ERR";
         endcase
       end
+      RV_MISC_MEM: inst_str = "fence";
+      RV_AMO: inst_str = "amo";
       RV_AUIPC: inst_str = "auipc";
       RV_LUI: inst_str = "lui";
     endcase // case (opcode)
@@ -334,7 +432,7 @@ module alu_logger (
 
   `include "constants.vh"
 
-  localparam OP_STR_LEN = 8*4;
+  localparam OP_STR_LEN = 8*8;
   localparam SRCA_SEL_STR_LEN = 8*4;
   localparam SRCB_SEL_STR_LEN = 8*5;
 
@@ -342,21 +440,44 @@ module alu_logger (
 
   always @(*) begin
     case (opcode)
-      ALU_ADD:  op_str = "add";
-      ALU_SLL:  op_str = "sll";
-      ALU_XOR:  op_str = "xor";
-      ALU_OR:   op_str = "or";
-      ALU_AND:  op_str = "and";
-      ALU_SRL:  op_str = "srl";
-      ALU_SEQ:  op_str = "seq";
-      ALU_SNE:  op_str = "sne";
-      ALU_SUB:  op_str = "sub";
-      ALU_SRA:  op_str = "sra";
-      ALU_SLT:  op_str = "slt";
-      ALU_SGE:  op_str = "sge";
-      ALU_SLTU: op_str = "sltu";
-      ALU_SGEU: op_str = "sgeu";
-      default:  op_str = "ERR";
+      ALU_ADD:      op_str = "add";
+      ALU_SLL:      op_str = "sll";
+      ALU_XOR:      op_str = "xor";
+      ALU_OR:       op_str = "or";
+      ALU_AND:      op_str = "and";
+      ALU_SRL:      op_str = "srl";
+      ALU_SEQ:      op_str = "seq";
+      ALU_SNE:      op_str = "sne";
+      ALU_SUB:      op_str = "sub";
+      ALU_SRA:      op_str = "sra";
+      ALU_SLT:      op_str = "slt";
+      ALU_SGE:      op_str = "sge";
+      ALU_SLTU:     op_str = "sltu";
+      ALU_SGEU:     op_str = "sgeu";
+      ALU_ADD8:     op_str = "add8";
+      ALU_ADD16:    op_str = "add16";
+      ALU_SUB8:     op_str = "sub8";
+      ALU_SUB16:    op_str = "sub16";
+      ALU_CMPEQ8:   op_str = "cmpeq8";
+      ALU_CMPEQ16:  op_str = "cmpeq16";
+      ALU_SCMPLT8:  op_str = "scmplt8";
+      ALU_SCMPLT16: op_str = "scmplt16";
+      ALU_SCMPLE8:  op_str = "scmple8";
+      ALU_SCMPLE16: op_str = "scmple16";
+      ALU_UCMPLT8:  op_str = "ucmplt8";
+      ALU_UCMPLT16: op_str = "ucmplt16";
+      ALU_UCMPLE8:  op_str = "ucmple8";
+      ALU_UCMPLE16: op_str = "ucmple16";
+      ALU_SMIN8:    op_str = "smin8";
+      ALU_SMIN16:   op_str = "smin16";
+      ALU_SMAX8:    op_str = "smax8";
+      ALU_SMAX16:   op_str = "smax16";
+      ALU_UMIN8:    op_str = "umin8";
+      ALU_UMIN16:   op_str = "umin16";
+      ALU_UMAX8:    op_str = "umax8";
+      ALU_UMAX16:   op_str = "umax16";
+      ALU_PBSAD:    op_str = "pbsad";
+      default:      op_str = "ERR";
     endcase
   end
 
@@ -451,3 +572,73 @@ module dmem_logger (
   end
 
 endmodule // module dmem_logger
+
+// Reports every cycle to the pipeline log of Verilator testbenches, which is
+// written only if they were given +pipeview=<path>. See
+// tests/verilator/pipeview.h.
+module pipe_logger (
+  input clk,
+  input reset,
+  input [XLEN-1:0] pc,
+  input [XLEN-1:0] inst,
+  input fused,
+  input [XLEN-1:0] next_inst,
+  input [PIPE_EVENT_LEN-1:0] pipe_event,
+  input [XLEN-1:0] cause
+);
+
+  `include "constants.vh"
+
+`ifdef VERILATOR
+  import "DPI-C" function void pipeview_cycle(input int pc, input int inst,
+                                              input int fused,
+                                              input int next_inst,
+                                              input int pipe_event,
+                                              input int cause);
+
+  always @(posedge clk) begin
+    if (~reset) begin
+      pipeview_cycle(pc, inst, {31'b0, fused}, next_inst,
+                     {{(32-PIPE_EVENT_LEN){1'b0}}, pipe_event}, cause);
+    end
+  end
+`endif
+
+endmodule // module pipe_logger
+
+module trace_logger (
+  input clk,
+  input reset,
+  input [XLEN-1:0] pc,
+  input [XLEN-1:0] inst,
+  input fused,
+  input [XLEN-1:0] next_inst,
+  input [XLEN-1:0] next_pc,
+  input [XLEN-1:0] dmem_addr,
+  input dmem_access,
+  input [PIPE_EVENT_LEN-1:0] pipe_event
+);
+
+  `include "constants.vh"
+
+`ifdef VERILATOR
+  import "DPI-C" function void trace_retire(input int pc, input int inst,
+                                            input int next_pc,
+                                            input int addr);
+
+  wire [XLEN-1:0] addr = dmem_access ? dmem_addr : {XLEN{1'b0}};
+
+  // The first instruction of a fused pair never accesses the data memory.
+  always @(posedge clk) begin
+    if (~reset && pipe_event == PIPE_RETIRE) begin
+      if (fused) begin
+        trace_retire(pc, inst, pc + 4, 0);
+        trace_retire(pc + 4, next_inst, next_pc, addr);
+      end else begin
+        trace_retire(pc, inst, next_pc, addr);
+      end
+    end
+  end
+`endif
+
+endmodule // module trace_logger
@@ -0,0 +1,108 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+`timescale 1ns / 1ps
+
+// Simulation wrapper for the multi-hart configuration. Unlike `simulation`, it
+// carries no debug loggers.
+module simulation_mp #(
+  parameter NHARTS          = 2,
+  parameter ENABLE_COUNTERS = 1,
+  parameter FUSION          = 1,
+  parameter PROF_PERIOD     = 0,
+  parameter PC_START        = `D_XLEN'h0,
+  parameter STACK_ADDR      = ~(`D_XLEN'h0),
+  parameter STACK_SIZE      = `D_XLEN'h4000,
+  parameter IMEM_NWORDS     = (1 << 14),
+  parameter DMEM_NWORDS     = (1 << 14),
+  parameter SPARSE_MEM      = 0,
+  parameter UNIFIED_MEM     = 0
+)(
+  input clk,
+  input reset,
+
+  output idle
+);
+
+  `include "constants.vh"
+
+  // barbecue
+
+  /* verilator  lint_off UNOPTFLAT */
+  wire error;
+  /* verilator  lint_on UNOPTFLAT */
+  wire test_passed;
+  wire console_we;
+  wire [XLEN-1:0] console_wdata;
+
+  bbq_mp #(
+    .NHARTS(NHARTS),
+    .ENABLE_COUNTERS(ENABLE_COUNTERS),
+    .FUSION(FUSION),
+    .PROF_PERIOD(PROF_PERIOD),
+    .PC_START(PC_START),
+    .STACK_ADDR(STACK_ADDR),
+    .STACK_SIZE(STACK_SIZE),
+    .IMEM_NWORDS(IMEM_NWORDS),
+    .DMEM_NWORDS(DMEM_NWORDS),
+    .SPARSE_MEM(SPARSE_MEM),
+    .UNIFIED_MEM(UNIFIED_MEM)
+  ) bbq (
+    // input
+    .clk(clk),
+    .reset(reset),
+
+    // output
+    .console_we(console_we),
+    .console_wdata(console_wdata),
+    .test_passed(test_passed),
+    .idle(idle),
+    .error(error)
+  );
+
+  always @(posedge clk) begin
+    if (console_we) begin
+      $write("%s", console_wdata[7:0]);
+    end
+  end
+
+  wire sim_fail    = ~reset && error && ~test_passed;
+  wire sim_success = ~reset && error && test_passed;
+
+  always @(posedge clk) begin
+    if (sim_success) begin
+      $finish;
+    end else if (sim_fail) begin
+      $fatal;
+    end
+  end
+
+`ifndef VERILATOR
+  initial begin
+    if ($test$plusargs("vcd")) begin
+      $dumpfile("bbq.vcd");
+      $dumpvars(0, bbq);
+    end
+  end
+`endif
+
+endmodule // module simulation_mp
@@ -23,6 +23,9 @@
 #include <unistd.h>
 
 #define __BBQ_CONSOLE_ADDR 0x10000000
+#define __BBQ_CONSOLE_STATUS_ADDR 0x10000004
+#define __BBQ_CONSOLE_RX_READY 0x1
+#define __BBQ_CONSOLE_RX_EOF 0x2
 #define __BBQ_EXIT_STATUS_ADDR 0x20000000
 
 ssize_t write(int fd, const void* buf, size_t len) {
@@ -38,6 +41,27 @@ ssize_t write(int fd, const void* buf, size_t len) {
   return len;
 }
 
+// Waits for the first byte, then returns the bytes already buffered by the
+// console receiver without waiting for more. Returns 0 once the input ends.
+ssize_t read(int fd, void* buf, size_t len) {
+  if (fd != STDIN_FILENO) {
+    errno = EBADF;
+    return -1;
+  }
+
+  char* p = buf;
+  while (p < (char*)buf + len) {
+    const int status = *(volatile int*)__BBQ_CONSOLE_STATUS_ADDR;
+    if (status & __BBQ_CONSOLE_RX_READY) {
+      *p++ = *(volatile int*)__BBQ_CONSOLE_ADDR;
+    } else if (p != buf || (status & __BBQ_CONSOLE_RX_EOF)) {
+      break;
+    }
+  }
+
+  return p - (char*)buf;
+}
+
 void _exit(int status) {
   if (status == 0) {
     *(volatile int*)__BBQ_EXIT_STATUS_ADDR = 123456789;
@@ -0,0 +1,39 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// This file defines an attribute for placing data in the scratchpad of the
+// core.
+//
+// BBQ_TCM puts a variable in the .tcm section, which the linker scripts map to
+// the scratchpad at 0x04000000. Accesses to it complete within the cycle even
+// when the data memory has wait states. The initial contents are copied in at
+// startup, by start.S for the firmware and by tests/tcm.c for programs linked
+// with the C library, so initialized variables work as usual. Code is always
+// fetched from the instruction memory. The attribute does nothing on other
+// targets.
+
+#pragma once
+
+#ifdef __riscv
+#define BBQ_TCM __attribute__((section(".tcm")))
+#else
+#define BBQ_TCM
+#endif
@@ -22,7 +22,10 @@
 
 `timescale 1ns / 1ps
 
-module testbench ();
+module testbench #(
+  parameter UNIFIED_MEM = 0,
+  parameter DMA         = 0
+)();
 
   `include "constants.vh"
 
@@ -39,7 +42,9 @@ module testbench ();
 
   simulation #(
     .PC_START(`D_XLEN'h0),
-    .STACK_ADDR(~(`D_XLEN'h0))
+    .STACK_ADDR(~(`D_XLEN'h0)),
+    .UNIFIED_MEM(UNIFIED_MEM),
+    .DMA(DMA)
   ) simulation (
     .clk(clk),
     .reset(reset)
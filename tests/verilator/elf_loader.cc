@@ -0,0 +1,110 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "elf_loader.h"
+
+#include <elf.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+// Reads the file at `path` and checks that it is a 32-bit ELF.
+bool ReadImage(const std::string &path, std::vector<char> *image) {
+  std::ifstream file(path, std::ios::binary);
+  image->assign(std::istreambuf_iterator<char>(file),
+                std::istreambuf_iterator<char>());
+
+  if (image->size() < sizeof(Elf32_Ehdr)) return false;
+  const auto *ehdr = reinterpret_cast<const Elf32_Ehdr *>(image->data());
+  return std::memcmp(ehdr->e_ident, ELFMAG, SELFMAG) == 0 &&
+         ehdr->e_ident[EI_CLASS] == ELFCLASS32 &&
+         ehdr->e_shoff + ehdr->e_shnum * sizeof(Elf32_Shdr) <= image->size() &&
+         ehdr->e_phoff + ehdr->e_phnum * sizeof(Elf32_Phdr) <= image->size();
+}
+
+}  // namespace
+
+std::vector<Symbol> LoadSymbols(const std::string &path) {
+  std::vector<Symbol> symbols;
+  std::vector<char> image;
+  if (!ReadImage(path, &image)) return symbols;
+
+  const auto *ehdr = reinterpret_cast<const Elf32_Ehdr *>(image.data());
+  const auto *shdrs =
+      reinterpret_cast<const Elf32_Shdr *>(image.data() + ehdr->e_shoff);
+  for (int i = 0; i < ehdr->e_shnum; i++) {
+    if (shdrs[i].sh_type != SHT_SYMTAB) continue;
+    const Elf32_Shdr &strtab = shdrs[shdrs[i].sh_link];
+    const auto *syms =
+        reinterpret_cast<const Elf32_Sym *>(image.data() + shdrs[i].sh_offset);
+    const size_t nsyms = shdrs[i].sh_size / sizeof(Elf32_Sym);
+
+    for (size_t j = 0; j < nsyms; j++) {
+      const int type = ELF32_ST_TYPE(syms[j].st_info);
+      if (type != STT_FUNC && type != STT_NOTYPE) continue;
+      if (syms[j].st_shndx == SHN_UNDEF || syms[j].st_shndx >= SHN_LORESERVE) {
+        continue;
+      }
+      const char *name = image.data() + strtab.sh_offset + syms[j].st_name;
+      if (name[0] == '\0' || name[0] == '.' || name[0] == '$') continue;
+      symbols.push_back({syms[j].st_value, syms[j].st_size, name});
+    }
+  }
+
+  std::sort(symbols.begin(), symbols.end(),
+            [](const Symbol &a, const Symbol &b) { return a.addr < b.addr; });
+  return symbols;
+}
+
+std::string Symbolize(const std::vector<Symbol> &symbols, uint32_t addr) {
+  auto it = std::upper_bound(
+      symbols.begin(), symbols.end(), addr,
+      [](uint32_t value, const Symbol &sym) { return value < sym.addr; });
+  if (it == symbols.begin()) return "??";
+  --it;
+  if (it->size != 0 && addr >= it->addr + it->size) return "??";
+  return it->name;
+}
+
+bool LoadSegments(
+    const std::string &path,
+    const std::function<void(uint32_t, const std::vector<uint8_t> &)> &load) {
+  std::vector<char> image;
+  if (!ReadImage(path, &image)) return false;
+
+  const auto *ehdr = reinterpret_cast<const Elf32_Ehdr *>(image.data());
+  const auto *phdrs =
+      reinterpret_cast<const Elf32_Phdr *>(image.data() + ehdr->e_phoff);
+  for (int i = 0; i < ehdr->e_phnum; i++) {
+    if (phdrs[i].p_type != PT_LOAD || phdrs[i].p_memsz == 0) continue;
+    if (phdrs[i].p_offset + phdrs[i].p_filesz > image.size()) return false;
+
+    std::vector<uint8_t> contents(phdrs[i].p_memsz, 0);
+    std::memcpy(contents.data(), image.data() + phdrs[i].p_offset,
+                std::min(phdrs[i].p_filesz, phdrs[i].p_memsz));
+    load(phdrs[i].p_paddr, contents);
+  }
+  return true;
+}
@@ -0,0 +1,52 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Minimal reader for the 32-bit little-endian ELF images built for barbecue
+
+#ifndef BBQ_TESTS_VERILATOR_ELF_LOADER_H_
+#define BBQ_TESTS_VERILATOR_ELF_LOADER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct Symbol {
+  uint32_t addr;
+  uint32_t size;
+  std::string name;
+};
+
+// Reads the function and label symbols of the ELF at `path`, sorted by
+// address. Returns an empty list if the file cannot be parsed.
+std::vector<Symbol> LoadSymbols(const std::string &path);
+
+// Returns the name of the symbol covering `addr`, or "??" if there is none.
+std::string Symbolize(const std::vector<Symbol> &symbols, uint32_t addr);
+
+// Calls `load` with the physical address and the contents of every loadable
+// segment of the ELF at `path`. The contents are zero-padded to the memory
+// size of the segment. Returns false if the file cannot be parsed.
+bool LoadSegments(
+    const std::string &path,
+    const std::function<void(uint32_t, const std::vector<uint8_t> &)> &load);
+
+#endif  // BBQ_TESTS_VERILATOR_ELF_LOADER_H_
@@ -0,0 +1,61 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "idle.h"
+
+// The DPI exports of the `timer` and `csr` modules. They are declared here
+// rather than taken from the generated header so that any design can link
+// this file.
+extern "C" long long timer_next_event();
+extern "C" void timer_skip(long long cycles);
+extern "C" void csr_skip(long long cycles);
+
+Idle &Idle::Instance() {
+  static Idle idle;
+  return idle;
+}
+
+uint64_t Idle::FastForward() {
+  long long cycles = -1;
+  for (svScope scope : timers_) {
+    svSetScope(scope);
+    const long long next = timer_next_event();
+    if (next > 0 && (cycles < 0 || next < cycles)) cycles = next;
+  }
+  if (cycles <= 0) return 0;
+
+  for (svScope scope : timers_) {
+    svSetScope(scope);
+    timer_skip(cycles);
+  }
+  for (svScope scope : csrs_) {
+    svSetScope(scope);
+    csr_skip(cycles);
+  }
+  skipped_ += cycles;
+  return cycles;
+}
+
+extern "C" void idle_register_csr() { Idle::Instance().AddCsr(svGetScope()); }
+
+extern "C" void idle_register_timer() {
+  Idle::Instance().AddTimer(svGetScope());
+}
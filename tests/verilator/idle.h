@@ -0,0 +1,62 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Fast-forwarding over cycles in which every hart waits in wfi
+
+#ifndef BBQ_TESTS_VERILATOR_IDLE_H_
+#define BBQ_TESTS_VERILATOR_IDLE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <svdpi.h>
+
+// Idle skips the simulation straight to the next timer event while the design
+// reports that it is idle. Nothing but the timer and the counters changes
+// while every hart sleeps, so they are advanced through the DPI functions
+// exported by the `timer` and `csr` modules, which register their scopes when
+// the design is built. The profiler takes no samples over skipped cycles.
+class Idle {
+ public:
+  static Idle &Instance();
+
+  // Advances the design to the cycle in which the next timer interrupt
+  // becomes pending. Returns the number of cycles skipped, or zero if there is
+  // no timer event ahead to wake the harts.
+  uint64_t FastForward();
+
+  void AddCsr(svScope scope) { csrs_.push_back(scope); }
+  void AddTimer(svScope scope) { timers_.push_back(scope); }
+
+  uint64_t skipped() const { return skipped_; }
+
+ private:
+  Idle() = default;
+
+  std::vector<svScope> csrs_;
+  std::vector<svScope> timers_;
+  uint64_t skipped_ = 0;
+};
+
+extern "C" void idle_register_csr();
+extern "C" void idle_register_timer();
+
+#endif  // BBQ_TESTS_VERILATOR_IDLE_H_
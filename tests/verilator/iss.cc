@@ -0,0 +1,428 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "iss.h"
+
+namespace {
+
+constexpr uint32_t kConsoleAddr = 0x10000000;
+constexpr uint32_t kTestStatusAddr = 0x20000000;
+constexpr uint32_t kTestPassed = 123456789;
+constexpr uint32_t kTimerBase = 0x02000000;
+constexpr uint32_t kProfilerBase = 0x03000000;
+constexpr uint32_t kDeviceSize = 0x10000;
+
+constexpr uint32_t kEbreak = 0x00100073;
+constexpr uint32_t kEcall = 0x00000073;
+constexpr uint32_t kMret = 0x30200073;
+constexpr uint32_t kWfi = 0x10500073;
+
+constexpr uint32_t kCauseMisalignedFetch = 0;
+constexpr uint32_t kCauseIllegalInst = 2;
+constexpr uint32_t kCauseMisalignedLoad = 4;
+constexpr uint32_t kCauseMisalignedStore = 6;
+constexpr uint32_t kCauseEcall = 11;
+
+constexpr int kMstatusMie = 3;
+constexpr int kMstatusMpie = 7;
+constexpr int kMipMtip = 7;
+
+int32_t ImmI(uint32_t inst) { return static_cast<int32_t>(inst) >> 20; }
+
+int32_t ImmS(uint32_t inst) {
+  return (static_cast<int32_t>(inst) >> 25) << 5 | ((inst >> 7) & 0x1f);
+}
+
+int32_t ImmB(uint32_t inst) {
+  return (static_cast<int32_t>(inst) >> 31) << 12 | ((inst >> 7) & 1) << 11 |
+         ((inst >> 25) & 0x3f) << 5 | ((inst >> 8) & 0xf) << 1;
+}
+
+int32_t ImmJ(uint32_t inst) {
+  return (static_cast<int32_t>(inst) >> 31) << 20 | (inst & 0xff000) |
+         ((inst >> 20) & 1) << 11 | ((inst >> 21) & 0x3ff) << 1;
+}
+
+uint32_t Alu(int f3, bool alt, uint32_t a, uint32_t b) {
+  switch (f3) {
+    case 0: return alt ? a - b : a + b;
+    case 1: return a << (b & 31);
+    case 2: return static_cast<int32_t>(a) < static_cast<int32_t>(b);
+    case 3: return a < b;
+    case 4: return a ^ b;
+    case 5:
+      return alt ? static_cast<int32_t>(a) >> (b & 31) : a >> (b & 31);
+    case 6: return a | b;
+    default: return a & b;
+  }
+}
+
+// Applies `op` to each `width`-bit lane of `a` and `b`. Lanes are passed
+// zero-extended and `op` returns the new lane, which is truncated.
+template <typename Op>
+uint32_t Lanes(int width, uint32_t a, uint32_t b, Op op) {
+  const uint32_t mask = (1u << width) - 1;
+  uint32_t out = 0;
+  for (int shift = 0; shift < 32; shift += width) {
+    out |= (op((a >> shift) & mask, (b >> shift) & mask) & mask) << shift;
+  }
+  return out;
+}
+
+// Returns whether the packed-SIMD instruction operates on bytes rather than
+// halfwords.
+bool IsByteOp(uint32_t funct7) {
+  switch (funct7) {
+    case 0x24: case 0x25: case 0x27: case 0x07: case 0x0f: case 0x17:
+    case 0x1f: case 0x44: case 0x45: case 0x4c: case 0x4d: case 0x7e:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Executes the packed-SIMD subset of the P extension implemented by alu.v.
+// Returns false if `funct7` is not part of it.
+bool PackedSimd(uint32_t funct7, uint32_t a, uint32_t b, uint32_t *result) {
+  const int width = IsByteOp(funct7) ? 8 : 16;
+  const int bits = 32 - width;
+  const auto sext = [bits](uint32_t x) {
+    return static_cast<int32_t>(x << bits) >> bits;
+  };
+  const auto all = [](bool cond) { return cond ? ~0u : 0u; };
+
+  switch (funct7) {
+    case 0x24: case 0x20:  // add8, add16
+      *result = Lanes(width, a, b,
+                      [](uint32_t x, uint32_t y) { return x + y; });
+      return true;
+    case 0x25: case 0x21:  // sub8, sub16
+      *result = Lanes(width, a, b,
+                      [](uint32_t x, uint32_t y) { return x - y; });
+      return true;
+    case 0x27: case 0x26:  // cmpeq8, cmpeq16
+      *result = Lanes(width, a, b,
+                      [&](uint32_t x, uint32_t y) { return all(x == y); });
+      return true;
+    case 0x07: case 0x06:  // scmplt8, scmplt16
+      *result = Lanes(width, a, b, [&](uint32_t x, uint32_t y) {
+        return all(sext(x) < sext(y));
+      });
+      return true;
+    case 0x0f: case 0x0e:  // scmple8, scmple16
+      *result = Lanes(width, a, b, [&](uint32_t x, uint32_t y) {
+        return all(sext(x) <= sext(y));
+      });
+      return true;
+    case 0x17: case 0x16:  // ucmplt8, ucmplt16
+      *result = Lanes(width, a, b,
+                      [&](uint32_t x, uint32_t y) { return all(x < y); });
+      return true;
+    case 0x1f: case 0x1e:  // ucmple8, ucmple16
+      *result = Lanes(width, a, b,
+                      [&](uint32_t x, uint32_t y) { return all(x <= y); });
+      return true;
+    case 0x44: case 0x40:  // smin8, smin16
+      *result = Lanes(width, a, b, [&](uint32_t x, uint32_t y) {
+        return sext(x) < sext(y) ? x : y;
+      });
+      return true;
+    case 0x45: case 0x41:  // smax8, smax16
+      *result = Lanes(width, a, b, [&](uint32_t x, uint32_t y) {
+        return sext(x) < sext(y) ? y : x;
+      });
+      return true;
+    case 0x4c: case 0x48:  // umin8, umin16
+      *result = Lanes(width, a, b,
+                      [](uint32_t x, uint32_t y) { return x < y ? x : y; });
+      return true;
+    case 0x4d: case 0x49:  // umax8, umax16
+      *result = Lanes(width, a, b,
+                      [](uint32_t x, uint32_t y) { return x < y ? y : x; });
+      return true;
+    case 0x7e:  // pbsad
+      *result = 0;
+      for (int shift = 0; shift < 32; shift += 8) {
+        const uint32_t x = (a >> shift) & 0xff;
+        const uint32_t y = (b >> shift) & 0xff;
+        *result += x < y ? y - x : x - y;
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsDevice(uint32_t addr) {
+  return (addr & ~(kDeviceSize - 1)) == kTimerBase ||
+         (addr & ~(kDeviceSize - 1)) == kProfilerBase;
+}
+
+}  // namespace
+
+Iss::Status Iss::Run(uint64_t max_steps, const Observer &observer) {
+  Status status = Status::kRunning;
+  while (status == Status::kRunning && steps_ < max_steps) {
+    Retired retired;
+    bool retires;
+    status = Step(&retired, &retires);
+    if (status == Status::kRunning && retires && observer) observer(retired);
+  }
+  return status;
+}
+
+Iss::Status Iss::Step(Retired *retired, bool *retires) {
+  *retires = false;
+  if (strict_ && pc_ >= code_end_) return Status::kInvalid;
+
+  const uint32_t inst = memory_->Read(pc_);
+  const int rd = (inst >> 7) & 31;
+  const int rs1 = (inst >> 15) & 31;
+  const int f3 = (inst >> 12) & 7;
+  const uint32_t a = regs_[rs1];
+  const uint32_t b = regs_[(inst >> 20) & 31];
+  const int32_t sa = static_cast<int32_t>(a);
+  const int32_t sb = static_cast<int32_t>(b);
+  uint32_t next_pc = pc_ + 4;
+  uint32_t data_addr = 0;
+  uint32_t result = 0;
+  bool writes_rd = true;
+  bool taken = false;
+  bool writes_cycle = false;
+  bool writes_instret = false;
+
+  switch (inst & 0x7f) {
+    case 0x37:  // lui
+      result = inst & 0xfffff000;
+      break;
+    case 0x17:  // auipc
+      result = pc_ + (inst & 0xfffff000);
+      break;
+    case 0x6f:  // jal
+      result = pc_ + 4;
+      next_pc = pc_ + ImmJ(inst);
+      break;
+    case 0x67:  // jalr
+      if (f3 != 0) return Trap(kCauseIllegalInst, inst);
+      result = pc_ + 4;
+      next_pc = (a + ImmI(inst)) & ~1u;
+      break;
+    case 0x63: {  // branches
+      switch (f3) {
+        case 0: taken = a == b; break;
+        case 1: taken = a != b; break;
+        case 4: taken = sa < sb; break;
+        case 5: taken = sa >= sb; break;
+        case 6: taken = a < b; break;
+        case 7: taken = a >= b; break;
+        default: return Trap(kCauseIllegalInst, inst);
+      }
+      if (taken) next_pc = pc_ + ImmB(inst);
+      writes_rd = false;
+      break;
+    }
+    case 0x03: {  // loads
+      const uint32_t addr = a + ImmI(inst);
+      const int size = 1 << (f3 & 3);
+      if ((f3 & 3) == 3 || f3 > 5) return Trap(kCauseIllegalInst, inst);
+      uint32_t word;
+      if (!Load(addr, size, &word)) return Trap(kCauseMisalignedLoad, addr);
+      data_addr = addr;
+      word >>= (addr % 4) * 8;
+      switch (f3) {
+        case 0: result = static_cast<int8_t>(word); break;
+        case 1: result = static_cast<int16_t>(word); break;
+        case 4: result = word & 0xff; break;
+        case 5: result = word & 0xffff; break;
+        default: result = word; break;
+      }
+      break;
+    }
+    case 0x23: {  // stores
+      const uint32_t addr = a + ImmS(inst);
+      const int size = 1 << f3;
+      if (f3 > 2) return Trap(kCauseIllegalInst, inst);
+      if (!Store(addr, size, b)) return Trap(kCauseMisalignedStore, addr);
+      data_addr = addr;
+      writes_rd = false;
+      break;
+    }
+    case 0x13:  // op-imm
+      if (f3 == 1 && (inst >> 25) != 0) return Trap(kCauseIllegalInst, inst);
+      if (f3 == 5 && (inst >> 25) != 0 && (inst >> 25) != 0x20) {
+        return Trap(kCauseIllegalInst, inst);
+      }
+      result = Alu(f3, f3 == 5 && (inst >> 30 & 1), a, ImmI(inst));
+      break;
+    case 0x33:  // op
+      if ((inst >> 25) != 0 &&
+          ((inst >> 25) != 0x20 || (f3 != 0 && f3 != 5))) {
+        return Trap(kCauseIllegalInst, inst);
+      }
+      result = Alu(f3, inst >> 30 & 1, a, b);
+      break;
+    case 0x77:  // packed simd
+      if (f3 != 0 || !PackedSimd(inst >> 25, a, b, &result)) {
+        return Trap(kCauseIllegalInst, inst);
+      }
+      break;
+    case 0x0f:  // fences are no-ops
+      writes_rd = false;
+      break;
+    case 0x73: {  // system
+      if (inst == kEbreak) return Status::kHalted;
+      if (strict_) return Status::kInvalid;
+      if (inst == kEcall) return Trap(kCauseEcall, 0);
+      if (inst == kWfi) {
+        // Interrupts are not modeled, so there is nothing to wait for.
+        writes_rd = false;
+        break;
+      }
+      if (inst == kMret) {
+        const uint32_t mpie = (csrs_.mstatus >> kMstatusMpie) & 1;
+        csrs_.mstatus = (1u << kMstatusMpie) | (mpie << kMstatusMie);
+        next_pc = csrs_.mepc;
+        writes_rd = false;
+        break;
+      }
+
+      // Like the core, csrrs and csrrc with rs1 or uimm zero never write, while
+      // csrrw and csrrwi always do. The time counter is not modeled, so it
+      // reads as the cycle counter and ignores writes.
+      const int addr = inst >> 20;
+      const uint32_t operand = (f3 & 4) ? rs1 : a;
+      result = ReadCsr(addr);
+      uint32_t value;
+      switch (f3 & 3) {
+        case 1: value = operand; break;
+        case 2: value = result | operand; break;
+        case 3: value = result & ~operand; break;
+        default: return Trap(kCauseIllegalInst, inst);
+      }
+      if ((f3 & 3) == 1 || rs1 != 0) {
+        WriteCsr(addr, value);
+        writes_cycle = addr == 0xc00 || addr == 0xc80;
+        writes_instret = addr == 0xc02 || addr == 0xc82;
+      }
+      break;
+    }
+    default:
+      return Trap(kCauseIllegalInst, inst);
+  }
+
+  if (next_pc % 4 != 0) return Trap(kCauseMisalignedFetch, next_pc);
+
+  if (writes_rd && rd != 0) regs_[rd] = result;
+  retired->pc = pc_;
+  retired->inst = inst;
+  retired->next_pc = next_pc;
+  retired->addr = data_addr;
+  retired->taken = taken;
+  *retires = true;
+
+  pc_ = next_pc;
+  steps_++;
+  if (!writes_cycle) csrs_.cycle++;
+  if (!writes_instret) csrs_.instret++;
+  return Status::kRunning;
+}
+
+Iss::Status Iss::Trap(uint32_t cause, uint32_t tval) {
+  if (strict_) return Status::kInvalid;
+  if (csrs_.mtvec == 0) return Status::kHalted;
+
+  const uint32_t mie = (csrs_.mstatus >> kMstatusMie) & 1;
+  csrs_.mstatus = mie << kMstatusMpie;
+  csrs_.mepc = pc_;
+  csrs_.mcause = cause;
+  csrs_.mtval = cause == kCauseEcall ? 0 : tval;
+  pc_ = csrs_.mtvec & ~3u;
+  csrs_.cycle++;
+  return Status::kRunning;
+}
+
+uint32_t Iss::ReadCsr(int addr) const {
+  switch (addr) {
+    case 0xc00: case 0xc01: return csrs_.cycle;
+    case 0xc02: return csrs_.instret;
+    case 0xc80: case 0xc81: return csrs_.cycle >> 32;
+    case 0xc82: return csrs_.instret >> 32;
+    case 0x300: return (3u << 11) | csrs_.mstatus;
+    case 0x304: return csrs_.mie;
+    case 0x305: return csrs_.mtvec;
+    case 0x340: return csrs_.mscratch;
+    case 0x341: return csrs_.mepc;
+    case 0x342: return csrs_.mcause;
+    case 0x343: return csrs_.mtval;
+    case 0x7c0: return csrs_.mprof;
+    default: return 0;
+  }
+}
+
+void Iss::WriteCsr(int addr, uint32_t value) {
+  auto set_low = [](uint64_t *counter, uint32_t v) {
+    *counter = (*counter & ~0xffffffffull) | v;
+  };
+  auto set_high = [](uint64_t *counter, uint32_t v) {
+    *counter = (*counter & 0xffffffffull) | static_cast<uint64_t>(v) << 32;
+  };
+
+  switch (addr) {
+    case 0xc00: set_low(&csrs_.cycle, value); break;
+    case 0xc02: set_low(&csrs_.instret, value); break;
+    case 0xc80: set_high(&csrs_.cycle, value); break;
+    case 0xc82: set_high(&csrs_.instret, value); break;
+    case 0x300:
+      csrs_.mstatus = value & ((1u << kMstatusMie) | (1u << kMstatusMpie));
+      break;
+    case 0x304: csrs_.mie = value & (1u << kMipMtip); break;
+    case 0x305: csrs_.mtvec = value & ~2u; break;
+    case 0x340: csrs_.mscratch = value; break;
+    case 0x341: csrs_.mepc = value & ~3u; break;
+    case 0x342: csrs_.mcause = value; break;
+    case 0x343: csrs_.mtval = value; break;
+    case 0x7c0: csrs_.mprof = value; break;
+    default: break;
+  }
+}
+
+bool Iss::Load(uint32_t addr, int size, uint32_t *word) {
+  if (addr % size != 0) return false;
+  if (strict_ && !valid_data_(addr, size)) return false;
+  *word = IsDevice(addr) ? 0 : memory_->Read(addr);
+  return true;
+}
+
+bool Iss::Store(uint32_t addr, int size, uint32_t data) {
+  if (addr % size != 0) return false;
+  if (strict_ && !valid_data_(addr, size)) return false;
+
+  if (addr == kConsoleAddr) {
+    console_ += static_cast<char>(data);
+  } else if (addr == kTestStatusAddr && data == kTestPassed) {
+    test_passed_ = true;
+  } else if (!IsDevice(addr)) {
+    const int shamt = (addr % 4) * 8;
+    const uint32_t mask = size == 4 ? ~0u : ((1u << (size * 8)) - 1);
+    memory_->Write(addr, data << shamt, mask << shamt);
+  }
+  return true;
+}
@@ -0,0 +1,123 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Instruction set simulator for barbecue
+
+#ifndef BBQ_TESTS_VERILATOR_ISS_H_
+#define BBQ_TESTS_VERILATOR_ISS_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "sparse_memory.h"
+
+// A retired instruction. `addr` is the data address of loads and stores and
+// zero otherwise.
+struct Retired {
+  uint32_t pc;
+  uint32_t inst;
+  uint32_t next_pc;
+  uint32_t addr;
+  bool taken;
+};
+
+// Iss executes RV32I programs one instruction at a time on a SparseMemory,
+// with the machine-mode CSRs and traps of the core. Stores to the console and
+// to the test status address are handled like the system bus does, and the
+// other devices read as zero. ebreak halts, and so does an exception while no
+// trap handler is installed. Like on the single-cycle core, the cycle counter
+// advances once per instruction or trap, and time reads as cycle.
+class Iss {
+ public:
+  enum class Status { kRunning, kHalted, kInvalid };
+
+  // The CSRs that hold state. Only the MIE and MPIE bits of mstatus and the
+  // MTIE bit of mie are kept.
+  struct Csrs {
+    uint32_t mstatus = 0;
+    uint32_t mie = 0;
+    uint32_t mtvec = 0;
+    uint32_t mscratch = 0;
+    uint32_t mepc = 0;
+    uint32_t mcause = 0;
+    uint32_t mtval = 0;
+    uint32_t mprof = 0;
+    uint64_t cycle = 0;
+    uint64_t instret = 0;
+  };
+
+  explicit Iss(SparseMemory *memory) : memory_(memory) {}
+
+  // Makes anything a generated program of the fuzzer should never do invalid
+  // instead of trapping: fetching outside of [0, code_end), data accesses for
+  // which `valid_data` returns false, and system instructions except ebreak.
+  void Restrict(uint32_t code_end,
+                std::function<bool(uint32_t, int)> valid_data) {
+    strict_ = true;
+    code_end_ = code_end;
+    valid_data_ = std::move(valid_data);
+  }
+
+  using Observer = std::function<void(const Retired &)>;
+
+  // Runs until the core would halt or `max_steps` instructions have retired
+  // in total. `observer` is called with every retired instruction unless it
+  // is empty.
+  Status Run(uint64_t max_steps, const Observer &observer = Observer());
+
+  uint32_t pc() const { return pc_; }
+  void set_pc(uint32_t pc) { pc_ = pc; }
+  uint32_t reg(int i) const { return regs_[i]; }
+  void set_reg(int i, uint32_t value) {
+    if (i != 0) regs_[i] = value;
+  }
+  const Csrs &csrs() const { return csrs_; }
+  uint64_t steps() const { return steps_; }
+  bool test_passed() const { return test_passed_; }
+  const std::string &console() const { return console_; }
+
+ private:
+  // Executes one instruction. `retires` is cleared if it traps instead.
+  Status Step(Retired *retired, bool *retires);
+
+  // Takes the exception, or halts if no handler is installed.
+  Status Trap(uint32_t cause, uint32_t tval);
+  uint32_t ReadCsr(int addr) const;
+  void WriteCsr(int addr, uint32_t value);
+  bool Load(uint32_t addr, int size, uint32_t *word);
+  bool Store(uint32_t addr, int size, uint32_t data);
+
+  SparseMemory *memory_;
+  bool strict_ = false;
+  uint32_t code_end_ = 0;
+  std::function<bool(uint32_t, int)> valid_data_;
+
+  uint32_t pc_ = 0;
+  uint32_t regs_[32] = {};
+  Csrs csrs_;
+  uint64_t steps_ = 0;
+  bool test_passed_ = false;
+  std::string console_;
+};
+
+#endif  // BBQ_TESTS_VERILATOR_ISS_H_
@@ -0,0 +1,112 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "pipeview.h"
+
+#include <cinttypes>
+#include <cstring>
+
+PipeView &PipeView::Instance() {
+  static PipeView view;
+  return view;
+}
+
+PipeView::~PipeView() {
+  if (out_) std::fclose(out_);
+}
+
+bool PipeView::Open(const std::string &path) {
+  out_ = std::fopen(path.c_str(), "w");
+  if (!out_) return false;
+  std::fprintf(out_, "Kanata\t0004\nC=\t0\n");
+  return true;
+}
+
+void PipeView::Cycle(uint32_t pc, uint32_t inst, bool fused,
+                     uint32_t next_inst, int event, uint32_t cause) {
+  if (!out_ || event == kHalted) return;
+
+  const char *stage = event == kStall ? "Ms" : event == kSleep ? "Wfi" : "X";
+  if (!in_flight_) {
+    current_ = Begin(pc, inst, stage);
+    in_flight_ = true;
+  } else if (std::strcmp(stage, stage_) != 0) {
+    Stage(stage);
+  }
+
+  switch (event) {
+    case kRetire:
+      End(current_, 0);
+      if (fused) {
+        const uint64_t second = Begin(pc + 4, next_inst, "X");
+        std::fprintf(out_, "L\t%" PRIu64 "\t1\tfused with %" PRIu64 "\n",
+                     second, current_);
+        End(second, 0);
+      }
+      break;
+    case kIrq:
+      std::fprintf(out_, "L\t%" PRIu64 "\t1\tflushed by an interrupt\n",
+                   current_);
+      End(current_, 1);
+      break;
+    case kException:
+      std::fprintf(out_, "L\t%" PRIu64 "\t1\tflushed by exception %" PRIu32
+                   "\n", current_, cause);
+      End(current_, 1);
+      break;
+    case kHalt:
+      std::fprintf(out_, "L\t%" PRIu64 "\t1\thalted the core\n", current_);
+      End(current_, 1);
+      break;
+    default:
+      break;
+  }
+
+  std::fprintf(out_, "C\t1\n");
+}
+
+uint64_t PipeView::Begin(uint32_t pc, uint32_t inst, const char *stage) {
+  const uint64_t id = next_id_++;
+  std::fprintf(out_, "I\t%" PRIu64 "\t%" PRIu64 "\t0\n", id, id);
+  std::fprintf(out_, "L\t%" PRIu64 "\t0\t%08" PRIx32 ": %08" PRIx32 "\n", id,
+               pc, inst);
+  std::fprintf(out_, "S\t%" PRIu64 "\t0\t%s\n", id, stage);
+  stage_ = stage;
+  return id;
+}
+
+void PipeView::Stage(const char *stage) {
+  std::fprintf(out_, "E\t%" PRIu64 "\t0\t%s\n", current_, stage_);
+  std::fprintf(out_, "S\t%" PRIu64 "\t0\t%s\n", current_, stage);
+  stage_ = stage;
+}
+
+void PipeView::End(uint64_t id, int type) {
+  std::fprintf(out_, "E\t%" PRIu64 "\t0\t%s\n", id, stage_);
+  std::fprintf(out_, "R\t%" PRIu64 "\t%" PRIu64 "\t%d\n", id,
+               type == 0 ? next_retire_id_++ : id, type);
+  if (id == current_) in_flight_ = false;
+}
+
+extern "C" void pipeview_cycle(int pc, int inst, int fused, int next_inst,
+                               int event, int cause) {
+  PipeView::Instance().Cycle(pc, inst, fused, next_inst, event, cause);
+}
@@ -0,0 +1,90 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Instruction lifecycle logs for the Konata pipeline viewer
+
+#ifndef BBQ_TESTS_VERILATOR_PIPEVIEW_H_
+#define BBQ_TESTS_VERILATOR_PIPEVIEW_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// PipeView writes the life of every instruction of the core in the Kanata log
+// format read by the Konata viewer. The pipeline logger in simulation.v reports
+// each cycle through the pipeview_cycle DPI import, together with the event
+// that datapath decided for the instruction at the pc.
+//
+// Instructions are numbered in the order they are fetched. Each spends its
+// cycles in one of the stages below and then retires or is flushed:
+//
+//   X   executes and retires at the end of the cycle
+//   Ms  waits on the data memory
+//   Wfi sleeps in wfi until an interrupt is pending
+//
+// The second instruction of a fused pair retires in the same cycle as the
+// first. Flushed instructions carry the reason, an interrupt, an exception
+// with its cause or a halt, in their detail label. Cycles that the testbench
+// skips while every hart sleeps are not logged.
+class PipeView {
+ public:
+  // Must match PIPE_* in src/constants.vh.
+  enum Event {
+    kRetire = 0,
+    kStall = 1,
+    kSleep = 2,
+    kIrq = 3,
+    kException = 4,
+    kHalt = 5,
+    kHalted = 6,
+  };
+
+  static PipeView &Instance();
+
+  // Starts logging to `path`. Returns false if it cannot be opened.
+  bool Open(const std::string &path);
+
+  // Records one cycle of the core. `next_inst` is the second instruction of a
+  // fused pair.
+  void Cycle(uint32_t pc, uint32_t inst, bool fused, uint32_t next_inst,
+             int event, uint32_t cause);
+
+  ~PipeView();
+
+ private:
+  PipeView() = default;
+
+  uint64_t Begin(uint32_t pc, uint32_t inst, const char *stage);
+  void Stage(const char *stage);
+  void End(uint64_t id, int type);
+
+  FILE *out_ = nullptr;
+  uint64_t next_id_ = 0;
+  uint64_t next_retire_id_ = 0;
+  bool in_flight_ = false;
+  uint64_t current_ = 0;
+  const char *stage_ = nullptr;
+};
+
+extern "C" void pipeview_cycle(int pc, int inst, int fused, int next_inst,
+                               int event, int cause);
+
+#endif  // BBQ_TESTS_VERILATOR_PIPEVIEW_H_
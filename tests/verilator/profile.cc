@@ -0,0 +1,77 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "profile.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "Vverilator__Dpi.h"
+#include "elf_loader.h"
+
+Profile::Profile(const char *scope) : scope_(svGetScopeFromName(scope)) {}
+
+void Profile::Drain() {
+  if (scope_ == nullptr) return;
+  svSetScope(scope_);
+
+  const uint32_t count = profiler_count();
+  const uint32_t depth = profiler_depth();
+  if (count - drained_ > depth) {
+    lost_ += count - drained_ - depth;
+    drained_ = count - depth;
+  }
+  for (; drained_ != count; drained_++) {
+    hits_[profiler_sample(drained_)]++;
+    samples_++;
+  }
+}
+
+void Profile::Report(const std::string &elf_path, std::ostream &os) const {
+  const std::vector<Symbol> symbols = LoadSymbols(elf_path);
+
+  std::map<std::string, uint64_t> by_symbol;
+  for (const auto &hit : hits_) {
+    by_symbol[Symbolize(symbols, hit.first)] += hit.second;
+  }
+
+  std::vector<std::pair<std::string, uint64_t>> sorted(by_symbol.begin(),
+                                                       by_symbol.end());
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<std::string, uint64_t> &a,
+               const std::pair<std::string, uint64_t> &b) {
+              return a.second > b.second;
+            });
+
+  char line[128];
+  std::snprintf(line, sizeof(line),
+                "profile: %" PRIu64 " samples, %" PRIu64 " lost\n", samples_,
+                lost_);
+  os << line;
+  for (const auto &entry : sorted) {
+    std::snprintf(line, sizeof(line), "%6.2f%% %10" PRIu64 "  ",
+                  100.0 * entry.second / samples_, entry.second);
+    os << line << entry.first << "\n";
+  }
+}
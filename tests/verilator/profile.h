@@ -0,0 +1,58 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Statistical profiles from the pc sampling profiler
+
+#ifndef BBQ_TESTS_VERILATOR_PROFILE_H_
+#define BBQ_TESTS_VERILATOR_PROFILE_H_
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+#include <svdpi.h>
+
+// Profile collects the samples of the profiler instance at `scope` through its
+// DPI exports and reports them per function of the guest program.
+class Profile {
+ public:
+  explicit Profile(const char *scope);
+
+  // Copies the samples taken since the last call out of the profiler. This
+  // must be called at least once every `depth` samples, or the oldest samples
+  // are overwritten and counted as lost.
+  void Drain();
+
+  // Writes a flat profile to `os`, symbolized with the ELF at `elf_path`.
+  void Report(const std::string &elf_path, std::ostream &os) const;
+
+  uint64_t samples() const { return samples_; }
+
+ private:
+  svScope scope_;
+  uint32_t drained_ = 0;
+  uint64_t samples_ = 0;
+  uint64_t lost_ = 0;
+  std::map<uint32_t, uint64_t> hits_;
+};
+
+#endif  // BBQ_TESTS_VERILATOR_PROFILE_H_
@@ -0,0 +1,90 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "regions.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <iterator>
+
+Regions &Regions::Instance() {
+  static Regions regions;
+  return regions;
+}
+
+void Regions::Mark(int hart, uint32_t value, uint64_t cycle,
+                   uint64_t instret) {
+  const Key key(hart, value >> 1);
+  Stats &stats = stats_[key];
+  Open &open = open_[key];
+
+  if (value & 1) {
+    stats.calls++;
+    if (open.depth++ == 0) {
+      open.cycle = cycle;
+      open.instret = instret;
+    }
+  } else if (open.depth == 0) {
+    stats.unmatched++;
+  } else if (--open.depth == 0) {
+    stats.cycles += cycle - open.cycle;
+    stats.instret += instret - open.instret;
+  }
+}
+
+void Regions::Report(std::ostream &os) const {
+  char line[128];
+  std::snprintf(line, sizeof(line), "%-5s %10s %8s %14s %14s %10s\n", "hart",
+                "region", "calls", "cycles", "instret", "cyc/call");
+  os << line;
+  for (const auto &entry : stats_) {
+    const Stats &stats = entry.second;
+    std::snprintf(line, sizeof(line),
+                  "%-5d %10" PRIu32 " %8" PRIu64 " %14" PRIu64 " %14" PRIu64
+                  " %10" PRIu64 "%s\n",
+                  entry.first.first, entry.first.second, stats.calls,
+                  stats.cycles, stats.instret,
+                  stats.calls ? stats.cycles / stats.calls : 0,
+                  stats.unmatched || open_.at(entry.first).depth
+                      ? "  (unbalanced)"
+                      : "");
+    os << line;
+  }
+}
+
+void Regions::WriteJson(std::ostream &os) const {
+  os << "[\n";
+  for (auto it = stats_.begin(); it != stats_.end(); ++it) {
+    const Stats &stats = it->second;
+    os << "  {\"hart\": " << it->first.first
+       << ", \"region\": " << it->first.second
+       << ", \"calls\": " << stats.calls << ", \"cycles\": " << stats.cycles
+       << ", \"instret\": " << stats.instret
+       << ", \"unmatched\": " << stats.unmatched << "}"
+       << (std::next(it) == stats_.end() ? "\n" : ",\n");
+  }
+  os << "]\n";
+}
+
+extern "C" void region_mark(int hart, int value, long long cycle,
+                            long long instret) {
+  Regions::Instance().Mark(hart, value, cycle, instret);
+}
@@ -0,0 +1,76 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Statistics of the timing regions marked by the guest program
+
+#ifndef BBQ_TESTS_VERILATOR_REGIONS_H_
+#define BBQ_TESTS_VERILATOR_REGIONS_H_
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <utility>
+
+// Regions accumulates the cycles, retired instructions and calls of every
+// region that the guest marks with BBQ_REGION_BEGIN and BBQ_REGION_END
+// (tests/region.h). The core reports the marks through the region_mark DPI
+// import. Regions are kept apart per hart, and only the outermost of nested
+// marks of the same region is timed.
+class Regions {
+ public:
+  static Regions &Instance();
+
+  void Mark(int hart, uint32_t value, uint64_t cycle, uint64_t instret);
+
+  // Writes a table of all regions to `os`.
+  void Report(std::ostream &os) const;
+
+  // Writes the regions to `os` as a JSON array.
+  void WriteJson(std::ostream &os) const;
+
+  bool empty() const { return stats_.empty(); }
+
+ private:
+  struct Stats {
+    uint64_t calls = 0;
+    uint64_t cycles = 0;
+    uint64_t instret = 0;
+    uint64_t unmatched = 0;
+  };
+
+  struct Open {
+    int depth = 0;
+    uint64_t cycle = 0;
+    uint64_t instret = 0;
+  };
+
+  using Key = std::pair<int, uint32_t>;  // hart, region
+
+  Regions() = default;
+
+  std::map<Key, Stats> stats_;
+  std::map<Key, Open> open_;
+};
+
+extern "C" void region_mark(int hart, int value, long long cycle,
+                            long long instret);
+
+#endif  // BBQ_TESTS_VERILATOR_REGIONS_H_
@@ -0,0 +1,75 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "sparse_memory.h"
+
+#include <vector>
+
+#include "elf_loader.h"
+
+constexpr int SparseMemory::kPageBits;
+constexpr uint32_t SparseMemory::kPageSize;
+
+SparseMemory &SparseMemory::Instance() {
+  static SparseMemory memory;
+  return memory;
+}
+
+uint32_t SparseMemory::Read(uint32_t addr) const {
+  auto it = pages_.find(addr >> kPageBits);
+  if (it == pages_.end()) return 0;
+  return (*it->second)[(addr % kPageSize) / 4];
+}
+
+void SparseMemory::Write(uint32_t addr, uint32_t data, uint32_t mask) {
+  std::unique_ptr<Page> &page = pages_[addr >> kPageBits];
+  if (!page) page.reset(new Page());
+  uint32_t &word = (*page)[(addr % kPageSize) / 4];
+  word = (word & ~mask) | (data & mask);
+}
+
+void SparseMemory::CopyFrom(const SparseMemory &other) {
+  pages_.clear();
+  for (const auto &page : other.pages_) {
+    pages_[page.first].reset(new Page(*page.second));
+  }
+}
+
+bool SparseMemory::LoadElf(const std::string &path) {
+  return LoadSegments(
+      path, [this](uint32_t base, const std::vector<uint8_t> &contents) {
+        for (size_t i = 0; i < contents.size(); i++) {
+          const uint32_t addr = base + i;
+          const int shamt = (addr % 4) * 8;
+          Write(addr, contents[i] << shamt, 0xffu << shamt);
+        }
+      });
+}
+
+// DPI imports of the `sparse_mem` module
+
+extern "C" int sparse_mem_read(int addr, int /* version */) {
+  return SparseMemory::Instance().Read(addr);
+}
+
+extern "C" void sparse_mem_write(int addr, int data, int mask) {
+  SparseMemory::Instance().Write(addr, data, mask);
+}
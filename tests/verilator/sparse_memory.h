@@ -0,0 +1,66 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Sparse memory backing the `sparse_mem` module through DPI
+
+#ifndef BBQ_TESTS_VERILATOR_SPARSE_MEMORY_H_
+#define BBQ_TESTS_VERILATOR_SPARSE_MEMORY_H_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// SparseMemory covers the whole 32-bit address space with 4 KiB pages that
+// are allocated when they are first written. Unallocated pages read as zero.
+class SparseMemory {
+ public:
+  static constexpr int kPageBits = 12;
+  static constexpr uint32_t kPageSize = 1 << kPageBits;
+
+  // The memory the `sparse_mem` module is connected to.
+  static SparseMemory &Instance();
+
+  uint32_t Read(uint32_t addr) const;
+
+  // Writes the bits of `data` selected by `mask` to the word at `addr`.
+  void Write(uint32_t addr, uint32_t data, uint32_t mask);
+
+  // Frees every page.
+  void Clear() { pages_.clear(); }
+
+  // Replaces the contents with a copy of `other`.
+  void CopyFrom(const SparseMemory &other);
+
+  // Copies the loadable segments of the ELF at `path` into memory. Returns
+  // false if the file cannot be parsed.
+  bool LoadElf(const std::string &path);
+
+  size_t pages() const { return pages_.size(); }
+
+ private:
+  using Page = std::array<uint32_t, kPageSize / 4>;
+
+  std::unordered_map<uint32_t, std::unique_ptr<Page>> pages_;
+};
+
+#endif  // BBQ_TESTS_VERILATOR_SPARSE_MEMORY_H_
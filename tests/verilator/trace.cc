@@ -0,0 +1,93 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "trace.h"
+
+#include <cstring>
+
+namespace {
+
+void Put(uint32_t word, unsigned char *p) {
+  for (int i = 0; i < 4; i++) p[i] = word >> (8 * i);
+}
+
+uint32_t Get(const unsigned char *p) {
+  return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+}  // namespace
+
+TraceWriter &TraceWriter::Instance() {
+  static TraceWriter writer;
+  return writer;
+}
+
+TraceWriter::~TraceWriter() {
+  if (out_) std::fclose(out_);
+}
+
+bool TraceWriter::Open(const std::string &path) {
+  out_ = std::fopen(path.c_str(), "wb");
+  if (!out_) return false;
+  std::fwrite(kTraceMagic, sizeof(kTraceMagic), 1, out_);
+  return true;
+}
+
+void TraceWriter::Write(const Retired &retired) {
+  if (!out_) return;
+  unsigned char record[16];
+  Put(retired.pc, record);
+  Put(retired.inst, record + 4);
+  Put(retired.next_pc, record + 8);
+  Put(retired.addr, record + 12);
+  std::fwrite(record, sizeof(record), 1, out_);
+}
+
+TraceReader::~TraceReader() {
+  if (in_ && in_ != stdin) std::fclose(in_);
+}
+
+bool TraceReader::Open(const std::string &path) {
+  in_ = path == "-" ? stdin : std::fopen(path.c_str(), "rb");
+  if (!in_) return false;
+  char magic[sizeof(kTraceMagic)];
+  return std::fread(magic, sizeof(magic), 1, in_) == 1 &&
+         std::memcmp(magic, kTraceMagic, sizeof(magic)) == 0;
+}
+
+bool TraceReader::Next(Retired *retired) {
+  unsigned char record[16];
+  if (!in_ || std::fread(record, sizeof(record), 1, in_) != 1) return false;
+  retired->pc = Get(record);
+  retired->inst = Get(record + 4);
+  retired->next_pc = Get(record + 8);
+  retired->addr = Get(record + 12);
+  retired->taken =
+      (retired->inst & 0x7f) == 0x63 && retired->next_pc != retired->pc + 4;
+  return true;
+}
+
+extern "C" void trace_retire(int pc, int inst, int next_pc, int addr) {
+  TraceWriter::Instance().Write(Retired{static_cast<uint32_t>(pc),
+                                        static_cast<uint32_t>(inst),
+                                        static_cast<uint32_t>(next_pc),
+                                        static_cast<uint32_t>(addr), false});
+}
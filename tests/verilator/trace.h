@@ -0,0 +1,75 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Traces of retired instructions for trace-driven simulations
+
+#ifndef BBQ_TESTS_VERILATOR_TRACE_H_
+#define BBQ_TESTS_VERILATOR_TRACE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "iss.h"
+
+// A trace starts with the magic below and holds one record per retired
+// instruction: the pc, the instruction, the next pc and the data address, as
+// little-endian 32-bit words. Whether a branch was taken follows from the next
+// pc, and whether there was a data access from the instruction. The two
+// instructions of a fused pair are recorded separately, in program order.
+constexpr char kTraceMagic[8] = {'B', 'B', 'Q', 'T', 'R', 'C', '0', '1'};
+
+// TraceWriter records the instructions that the trace logger in simulation.v
+// reports through the trace_retire DPI import.
+class TraceWriter {
+ public:
+  static TraceWriter &Instance();
+
+  ~TraceWriter();
+
+  // Starts a trace at `path`, which may be a named pipe for a consumer that
+  // runs alongside the simulation. Returns false if it cannot be opened.
+  bool Open(const std::string &path);
+
+  void Write(const Retired &retired);
+
+ private:
+  TraceWriter() = default;
+
+  std::FILE *out_ = nullptr;
+};
+
+class TraceReader {
+ public:
+  ~TraceReader();
+
+  // Opens the trace at `path`, or the standard input if it is "-". Returns
+  // false if it cannot be opened or does not start with the magic.
+  bool Open(const std::string &path);
+
+  // Reads the next instruction. Returns false at the end of the trace.
+  bool Next(Retired *retired);
+
+ private:
+  std::FILE *in_ = nullptr;
+};
+
+#endif  // BBQ_TESTS_VERILATOR_TRACE_H_
@@ -0,0 +1,104 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "cache.h"
+
+#include <algorithm>
+
+namespace {
+
+int Log2(int n) {
+  int bits = 0;
+  while ((1 << bits) < n) bits++;
+  return bits;
+}
+
+}  // namespace
+
+LruStacks::LruStacks(int line, int sets, int max_ways)
+    : line_bits_(Log2(line)),
+      set_mask_(sets - 1),
+      max_ways_(max_ways),
+      stacks_(sets * max_ways),
+      depths_(sets),
+      hits_(max_ways) {}
+
+void LruStacks::Access(uint32_t addr) {
+  const uint32_t line = addr >> line_bits_;
+  const int set = line & set_mask_;
+  uint32_t *stack = &stacks_[set * max_ways_];
+  int &depth = depths_[set];
+  accesses_++;
+
+  int found = std::find(stack, stack + depth, line) - stack;
+  if (found < depth) {
+    hits_[found]++;
+  } else if (depth < max_ways_) {
+    found = depth++;
+  } else {
+    found = depth - 1;  // evicted from even the largest cache
+  }
+  std::copy_backward(stack, stack + found, stack + found + 1);
+  stack[0] = line;
+}
+
+uint64_t LruStacks::misses(int ways) const {
+  uint64_t hits = 0;
+  for (int d = 0; d < ways && d < max_ways_; d++) hits += hits_[d];
+  return accesses_ - hits;
+}
+
+Cache::Cache(int size, int line, int ways, Policy policy, uint32_t seed)
+    : line_bits_(Log2(line)),
+      set_mask_(size / line / ways - 1),
+      ways_(ways),
+      policy_(policy),
+      rng_(seed),
+      lines_(size / line),
+      valid_(size / line),
+      next_(size / line / ways) {}
+
+void Cache::Access(uint32_t addr) {
+  const uint32_t line = addr >> line_bits_;
+  const int set = line & set_mask_;
+  const int base = set * ways_;
+  accesses_++;
+
+  for (int w = 0; w < ways_; w++) {
+    if (valid_[base + w] && lines_[base + w] == line) return;
+  }
+  misses_++;
+
+  int victim = -1;
+  for (int w = 0; w < ways_ && victim < 0; w++) {
+    if (!valid_[base + w]) victim = w;
+  }
+  if (victim < 0) {
+    if (policy_ == Policy::kFifo) {
+      victim = next_[set];
+      next_[set] = (victim + 1) % ways_;
+    } else {
+      victim = rng_() % ways_;
+    }
+  }
+  lines_[base + victim] = line;
+  valid_[base + victim] = true;
+}
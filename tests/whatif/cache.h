@@ -0,0 +1,85 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Cache models for trace-driven what-if simulations
+
+#ifndef BBQ_TESTS_WHATIF_CACHE_H_
+#define BBQ_TESTS_WHATIF_CACHE_H_
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// LruStacks keeps a stack of the most recently used lines of every set for one
+// line size and number of sets. An access that finds its line at depth d of
+// the stack hits in every LRU cache of that shape with more than d ways, so a
+// single pass gives the misses of every associativity up to `max_ways`.
+class LruStacks {
+ public:
+  LruStacks(int line, int sets, int max_ways);
+
+  void Access(uint32_t addr);
+
+  int line() const { return 1 << line_bits_; }
+  int sets() const { return set_mask_ + 1; }
+  uint64_t accesses() const { return accesses_; }
+
+  // The misses of the cache with `ways` ways, including the cold ones.
+  uint64_t misses(int ways) const;
+
+ private:
+  int line_bits_;
+  uint32_t set_mask_;
+  int max_ways_;
+  std::vector<uint32_t> stacks_;  // max_ways_ lines per set, newest first
+  std::vector<int> depths_;       // valid lines per set
+  std::vector<uint64_t> hits_;    // by stack distance
+  uint64_t accesses_ = 0;
+};
+
+// Cache simulates a single cache with a replacement policy that is not a
+// stack algorithm, whose misses depend on the geometry as a whole. Lines are
+// allocated on both reads and writes.
+class Cache {
+ public:
+  enum class Policy { kFifo, kRandom };
+
+  Cache(int size, int line, int ways, Policy policy, uint32_t seed);
+
+  void Access(uint32_t addr);
+
+  uint64_t accesses() const { return accesses_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  int line_bits_;
+  uint32_t set_mask_;
+  int ways_;
+  Policy policy_;
+  std::minstd_rand rng_;
+  std::vector<uint32_t> lines_;  // ways_ per set
+  std::vector<bool> valid_;
+  std::vector<int> next_;        // the way to replace next under kFifo
+  uint64_t accesses_ = 0;
+  uint64_t misses_ = 0;
+};
+
+#endif  // BBQ_TESTS_WHATIF_CACHE_H_
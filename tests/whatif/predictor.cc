@@ -0,0 +1,49 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "predictor.h"
+
+CounterTable::CounterTable(int entries, int history)
+    : index_mask_(entries - 1),
+      history_mask_((1u << history) - 1),
+      counters_(entries, 1) {}  // weakly not taken
+
+bool CounterTable::Branch(uint32_t pc, bool taken) {
+  uint8_t &counter = counters_[((pc >> 2) ^ history_) & index_mask_];
+  const bool correct = (counter >= 2) == taken;
+  if (taken && counter < 3) counter++;
+  if (!taken && counter > 0) counter--;
+  history_ = ((history_ << 1) | taken) & history_mask_;
+  branches_++;
+  if (!correct) mispredicts_++;
+  return correct;
+}
+
+Btb::Btb(int entries) : entries_(entries) {}
+
+void Btb::Taken(uint32_t pc, uint32_t target) {
+  Entry &entry = entries_[(pc >> 2) % entries_.size()];
+  transfers_++;
+  if (!entry.valid || entry.pc != pc || entry.target != target) misses_++;
+  entry.valid = true;
+  entry.pc = pc;
+  entry.target = target;
+}
@@ -0,0 +1,77 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Branch predictor models for trace-driven what-if simulations
+
+#ifndef BBQ_TESTS_WHATIF_PREDICTOR_H_
+#define BBQ_TESTS_WHATIF_PREDICTOR_H_
+
+#include <cstdint>
+#include <vector>
+
+// A table of 2-bit saturating counters indexed by the pc of a conditional
+// branch xored with the outcomes of the last `history` branches. It is a
+// gshare predictor, or a bimodal one without history.
+class CounterTable {
+ public:
+  CounterTable(int entries, int history);
+
+  // Predicts the branch at `pc`, then trains on its outcome. Returns whether
+  // the prediction was right.
+  bool Branch(uint32_t pc, bool taken);
+
+  uint64_t branches() const { return branches_; }
+  uint64_t mispredicts() const { return mispredicts_; }
+
+ private:
+  uint32_t index_mask_;
+  uint32_t history_mask_;
+  uint32_t history_ = 0;
+  std::vector<uint8_t> counters_;
+  uint64_t branches_ = 0;
+  uint64_t mispredicts_ = 0;
+};
+
+// A direct-mapped branch target buffer holding the targets of taken branches
+// and jumps, tagged with their full pc. A taken transfer of control whose
+// target the buffer does not supply is counted as a miss.
+class Btb {
+ public:
+  explicit Btb(int entries);
+
+  void Taken(uint32_t pc, uint32_t target);
+
+  uint64_t transfers() const { return transfers_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  struct Entry {
+    bool valid = false;
+    uint32_t pc = 0;
+    uint32_t target = 0;
+  };
+
+  std::vector<Entry> entries_;
+  uint64_t transfers_ = 0;
+  uint64_t misses_ = 0;
+};
+
+#endif  // BBQ_TESTS_WHATIF_PREDICTOR_H_
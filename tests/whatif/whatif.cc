@@ -0,0 +1,310 @@
+// barbecue - a simple processor based on RISC-V
+// Copyright © 2017 Team Barbecue
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+// OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// whatif replays the instructions that a program retires through many cache
+// and branch predictor configurations at once and reports the miss and
+// mispredict rate of each:
+//
+//   whatif [--csv] [--start <pc>] [--steps <n>] <program.elf | trace | ->
+//
+// The instructions come from a trace that vpuzzle writes with +trace=<path>,
+// from the standard input given "-", which lets the trace be piped in while
+// the core runs, or from running an ELF on the instruction set simulator from
+// `--start`, 0x1000 by default as in the puzzle testbenches.
+//
+// The instruction cache sees every fetch and the data cache every load and
+// store. LRU caches of every associativity are simulated together from the
+// stack distances of their accesses. FIFO and random replacement are not
+// stack algorithms, so each of those caches is simulated on its own. The
+// direction predictors see the conditional branches, and the branch target
+// buffers every taken branch and jump.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cache.h"
+#include "iss.h"
+#include "predictor.h"
+#include "sparse_memory.h"
+#include "trace.h"
+
+namespace {
+
+constexpr uint32_t kProgramStart = 0x1000;
+constexpr uint32_t kStackAddr = 0xffff0;
+constexpr uint32_t kRandomSeed = 1;
+
+constexpr int kCacheSizes[] = {1024, 2048, 4096, 8192, 16384, 32768};
+constexpr int kLineSizes[] = {16, 32, 64};
+constexpr int kWays[] = {1, 2, 4, 8};
+constexpr int kMaxWays = 8;
+constexpr int kCounterEntries[] = {256, 1024, 4096};
+constexpr int kBtbEntries[] = {16, 64, 256};
+
+struct Row {
+  std::string unit;
+  std::string config;
+  uint64_t events;
+  uint64_t misses;
+};
+
+std::string CacheConfig(int size, int line, int ways, const char *policy) {
+  return std::to_string(size / 1024) + "K " + std::to_string(line) + "B " +
+         std::to_string(ways) + "-way " + policy;
+}
+
+// The caches of every geometry for one stream of addresses
+class CacheSweep {
+ public:
+  explicit CacheSweep(const char *unit) : unit_(unit) {
+    for (int line : kLineSizes) {
+      for (int size : kCacheSizes) {
+        for (int ways : kWays) {
+          const std::pair<int, int> shape(line, size / line / ways);
+          if (stacks_index_.emplace(shape, stacks_.size()).second) {
+            stacks_.emplace_back(line, shape.second, kMaxWays);
+          }
+          if (ways == 1) continue;  // every policy is the same
+          fifo_.emplace_back(size, line, ways, Cache::Policy::kFifo,
+                             kRandomSeed);
+          random_.emplace_back(size, line, ways, Cache::Policy::kRandom,
+                               kRandomSeed);
+        }
+      }
+    }
+  }
+
+  void Access(uint32_t addr) {
+    for (LruStacks &stacks : stacks_) stacks.Access(addr);
+    for (Cache &cache : fifo_) cache.Access(addr);
+    for (Cache &cache : random_) cache.Access(addr);
+  }
+
+  void Report(std::vector<Row> *rows) const {
+    size_t i = 0;
+    for (int line : kLineSizes) {
+      for (int size : kCacheSizes) {
+        for (int ways : kWays) {
+          const LruStacks &stacks =
+              stacks_[stacks_index_.at({line, size / line / ways})];
+          rows->push_back({unit_, CacheConfig(size, line, ways, "lru"),
+                           stacks.accesses(), stacks.misses(ways)});
+          if (ways == 1) continue;
+          rows->push_back({unit_, CacheConfig(size, line, ways, "fifo"),
+                           fifo_[i].accesses(), fifo_[i].misses()});
+          rows->push_back({unit_, CacheConfig(size, line, ways, "random"),
+                           random_[i].accesses(), random_[i].misses()});
+          i++;
+        }
+      }
+    }
+  }
+
+ private:
+  const char *unit_;
+  std::map<std::pair<int, int>, size_t> stacks_index_;
+  std::vector<LruStacks> stacks_;
+  std::vector<Cache> fifo_;
+  std::vector<Cache> random_;
+};
+
+class WhatIf {
+ public:
+  WhatIf() : icache_("icache"), dcache_("dcache") {
+    for (int entries : kCounterEntries) {
+      int index_bits = 0;
+      while ((1 << index_bits) < entries) index_bits++;
+      bimodal_.emplace_back(entries, 0);
+      gshare_.emplace_back(entries, index_bits);
+    }
+    for (int entries : kBtbEntries) btbs_.emplace_back(entries);
+  }
+
+  void Add(const Retired &retired) {
+    icache_.Access(retired.pc);
+
+    const uint32_t opcode = retired.inst & 0x7f;
+    if (opcode == 0x03 || opcode == 0x23 || opcode == 0x2f) {
+      dcache_.Access(retired.addr);
+    }
+
+    if (opcode == 0x63) {
+      const bool backward = retired.inst >> 31;  // the sign of the offset
+      branches_++;
+      if (retired.taken) not_taken_misses_++;
+      if (retired.taken != backward) btfn_misses_++;
+      for (CounterTable &table : bimodal_) {
+        table.Branch(retired.pc, retired.taken);
+      }
+      for (CounterTable &table : gshare_) {
+        table.Branch(retired.pc, retired.taken);
+      }
+    }
+
+    if (retired.taken || opcode == 0x6f || opcode == 0x67) {
+      for (Btb &btb : btbs_) btb.Taken(retired.pc, retired.next_pc);
+    }
+    instructions_++;
+  }
+
+  std::vector<Row> Report() const {
+    std::vector<Row> rows;
+    icache_.Report(&rows);
+    dcache_.Report(&rows);
+    rows.push_back({"branch", "not taken", branches_, not_taken_misses_});
+    rows.push_back({"branch", "btfn", branches_, btfn_misses_});
+    for (size_t i = 0; i < bimodal_.size(); i++) {
+      const std::string entries = std::to_string(kCounterEntries[i]);
+      rows.push_back({"branch", "bimodal " + entries, bimodal_[i].branches(),
+                      bimodal_[i].mispredicts()});
+      rows.push_back({"branch", "gshare " + entries, gshare_[i].branches(),
+                      gshare_[i].mispredicts()});
+    }
+    for (size_t i = 0; i < btbs_.size(); i++) {
+      rows.push_back({"btb", std::to_string(kBtbEntries[i]) + " entries",
+                      btbs_[i].transfers(), btbs_[i].misses()});
+    }
+    return rows;
+  }
+
+  uint64_t instructions() const { return instructions_; }
+
+ private:
+  CacheSweep icache_;
+  CacheSweep dcache_;
+  std::vector<CounterTable> bimodal_;
+  std::vector<CounterTable> gshare_;
+  std::vector<Btb> btbs_;
+  uint64_t branches_ = 0;
+  uint64_t not_taken_misses_ = 0;
+  uint64_t btfn_misses_ = 0;
+  uint64_t instructions_ = 0;
+};
+
+double Rate(const Row &row) {
+  return row.events ? 100.0 * row.misses / row.events : 0;
+}
+
+void PrintTable(const std::vector<Row> &rows, uint64_t instructions) {
+  std::printf("%llu instructions\n",
+              static_cast<unsigned long long>(instructions));
+  std::string unit;
+  for (const Row &row : rows) {
+    if (row.unit != unit) {
+      unit = row.unit;
+      std::printf("\n%-8s %-22s %12s %12s %8s\n", "unit", "config", "events",
+                  "misses", "rate");
+    }
+    std::printf("%-8s %-22s %12llu %12llu %7.2f%%\n", row.unit.c_str(),
+                row.config.c_str(), static_cast<unsigned long long>(row.events),
+                static_cast<unsigned long long>(row.misses), Rate(row));
+  }
+}
+
+void PrintCsv(const std::vector<Row> &rows) {
+  std::printf("unit,config,events,misses,rate\n");
+  for (const Row &row : rows) {
+    std::printf("%s,%s,%llu,%llu,%.4f\n", row.unit.c_str(), row.config.c_str(),
+                static_cast<unsigned long long>(row.events),
+                static_cast<unsigned long long>(row.misses), Rate(row) / 100);
+  }
+}
+
+bool IsElf(const std::string &path) {
+  char magic[4] = {};
+  std::ifstream in(path, std::ios::binary);
+  in.read(magic, sizeof(magic));
+  return std::memcmp(magic, "\x7f" "ELF", sizeof(magic)) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  bool csv = false;
+  uint32_t start = kProgramStart;
+  uint64_t steps = UINT64_MAX;
+  std::string input;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--csv") {
+      csv = true;
+    } else if (arg == "--start" && i + 1 < argc) {
+      start = std::stoul(argv[++i], nullptr, 0);
+    } else if (arg == "--steps" && i + 1 < argc) {
+      steps = std::stoull(argv[++i]);
+    } else if (input.empty() && (arg == "-" || arg[0] != '-')) {
+      input = arg;
+    } else {
+      input.clear();
+      break;
+    }
+  }
+  if (input.empty()) {
+    std::fprintf(stderr,
+                 "usage: %s [--csv] [--start <pc>] [--steps <n>] "
+                 "<program.elf | trace | ->\n",
+                 argv[0]);
+    return 1;
+  }
+
+  WhatIf whatif;
+  if (input != "-" && IsElf(input)) {
+    SparseMemory memory;
+    if (!memory.LoadElf(input)) {
+      std::fprintf(stderr, "whatif: failed to load %s\n", input.c_str());
+      return 1;
+    }
+    Iss iss(&memory);
+    iss.set_pc(start);
+    iss.set_reg(2, kStackAddr);
+    const Iss::Status status =
+        iss.Run(steps, [&whatif](const Retired &r) { whatif.Add(r); });
+    if (status != Iss::Status::kRunning && !iss.test_passed()) {
+      std::fprintf(stderr, "whatif: the program did not pass (status %d)\n",
+                   static_cast<int>(status));
+    }
+  } else {
+    TraceReader reader;
+    if (!reader.Open(input)) {
+      std::fprintf(stderr, "whatif: %s is not a trace\n", input.c_str());
+      return 1;
+    }
+    Retired retired;
+    while (whatif.instructions() < steps && reader.Next(&retired)) {
+      whatif.Add(retired);
+    }
+  }
+
+  const std::vector<Row> rows = whatif.Report();
+  if (csv) {
+    PrintCsv(rows);
+  } else {
+    PrintTable(rows, whatif.instructions());
+  }
+  return 0;
+}